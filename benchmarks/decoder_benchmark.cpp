@@ -0,0 +1,120 @@
+// Compares the schema specialised EventMessageDecoder with the generic
+// QJsonDocument path EventReceiver used before. Both sides produce the same
+// output (client id plus type, message and timestamp as QString), so the
+// numbers are lines per second of the complete parse step on one thread.
+//
+// Build with -DEVENTMONITOR_BUILD_BENCHMARKS=ON and run ./decoder_benchmark [lines]
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QTextStream>
+#include <QRandomGenerator>
+#include <algorithm>
+
+#include "eventdecoder.h"
+
+namespace {
+
+constexpr double s_requiredSpeedup {5.0};
+
+QList<QByteArray> makeLines(const int count)
+{
+    static const char *const types[] = {"DATA", "DATA", "DATA", "INFO", "WARNING", "ERROR"};
+    QList<QByteArray> lines;
+    lines.reserve(count);
+    QRandomGenerator rng(42);
+    for (int i = 0; i < count; ++i)
+    {
+        const char *type = types[rng.bounded(6)];
+        QByteArray text;
+        if (qstrcmp(type, "DATA") == 0)
+            text = QByteArray("X:") + QByteArray::number(rng.bounded(100.0), 'f', 6)
+                   + ", Y:" + QByteArray::number(rng.bounded(100.0), 'f', 6);
+        else if (i % 10 == 0)
+            text = "Value entered \\\"WARNING\\\" range: " + QByteArray::number(rng.bounded(100.0), 'f', 2);
+        else
+            text = "Value stable for last 5 samples (avg = " + QByteArray::number(rng.bounded(100.0), 'f', 2) + ")";
+
+        lines.append(QByteArray("{\"type\": \"") + type + "\", \"message\": \"" + text
+                     + "\", \"client\": " + QByteArray::number(1 + rng.bounded(3))
+                     + ", \"timestamp\": \"2025-05-06 06:29:51\"}");
+    }
+    return lines;
+}
+
+struct Result {
+    double linesPerSecond;
+    qint64 checksum;
+};
+
+template<class F>
+Result measure(const QList<QByteArray> &lines, const int rounds, F &&parseOne)
+{
+    qint64 checksum {0};
+    QElapsedTimer timer;
+    timer.start();
+    for (int r = 0; r < rounds; ++r)
+        for (const QByteArray &line : lines)
+            checksum += parseOne(line);
+    const qint64 ns = std::max<qint64>(1, timer.nsecsElapsed());
+    return {double(lines.size()) * rounds * 1e9 / double(ns), checksum};
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    const int lineCount = argc > 1 ? QByteArray(argv[1]).toInt() : 200000;
+    const QList<QByteArray> lines = makeLines(std::max(1, lineCount));
+    constexpr int rounds = 5;
+
+    const Result generic = measure(lines, rounds, [](const QByteArray &line) -> qint64 {
+        QJsonParseError parseError;
+        const QJsonDocument doc = QJsonDocument::fromJson(line, &parseError);
+        if (parseError.error != QJsonParseError::NoError || !doc.isObject())
+            return 0;
+        const QJsonObject obj = doc.object();
+        const int client = obj["client"].toInt();
+        const QString type = obj["type"].toString();
+        const QString message = obj["message"].toString();
+        const QString timestamp = obj["timestamp"].toString();
+        return client + type.size() + message.size() + timestamp.size();
+    });
+
+    EventMessageDecoder decoder;
+    const Result specialised = measure(lines, rounds, [&decoder](const QByteArray &line) -> qint64 {
+        EventFields fields;
+        if (!decoder.decode(line, fields))
+            return 0;
+        const QString type = QString::fromLatin1(fields.type);
+        const QString message = QString::fromUtf8(fields.message);
+        const QString timestamp = QString::fromLatin1(fields.timestamp);
+        return fields.client + type.size() + message.size() + timestamp.size();
+    });
+
+    const double speedup = specialised.linesPerSecond / generic.linesPerSecond;
+    out << "lines per round:        " << lines.size() << "\n"
+        << "QJsonDocument:          " << qint64(generic.linesPerSecond) << " lines/s\n"
+        << "EventMessageDecoder:    " << qint64(specialised.linesPerSecond) << " lines/s\n"
+        << "fallbacks:              " << decoder.fallbackCount() << "\n"
+        << "speedup:                " << QString::number(speedup, 'f', 2) << "x\n";
+
+    if (generic.checksum != specialised.checksum)
+    {
+        out << "FAIL: decoders disagree on the parsed content\n";
+        return 1;
+    }
+    if (speedup < s_requiredSpeedup)
+    {
+        out << "FAIL: expected at least " << s_requiredSpeedup << "x\n";
+        return 1;
+    }
+    out << "PASS\n";
+    return 0;
+}
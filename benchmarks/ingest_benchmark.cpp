@@ -0,0 +1,217 @@
+// Compares the QTcpServer based EventReceiver with the EpollReceiver under a
+// large number of concurrent connections. For each backend the benchmark opens
+// N client connections, then every connection sends the same number of event
+// lines while the main thread drains the EventMessageRing like the Controller
+// does. Reported are the time to establish the connections and the end to end
+// message rate until the last line was received.
+//
+// Build with -DEVENTMONITOR_BUILD_BENCHMARKS=ON and run
+// ./ingest_benchmark [connections] [linesPerConnection] [receiverThreads] [port]
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QTextStream>
+#include <QThread>
+#include <QTimer>
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "eventreceiver.h"
+#include "epollreceiver.h"
+
+namespace {
+
+constexpr size_t s_ringCapacity {16384U};
+constexpr qint64 s_timeoutMs {60000};
+constexpr int s_spareDescriptors {64};
+
+struct Result {
+    bool ok {false};
+    double connectMs {0.0};
+    double messagesPerSecond {0.0};
+    qint64 received {0};
+};
+
+// Client and server side of every connection live in this process
+int raiseDescriptorLimit(const int connections)
+{
+    rlimit limit {};
+    if (::getrlimit(RLIMIT_NOFILE, &limit) != 0)
+        return connections;
+    const rlim_t wanted = rlim_t(connections) * 2 + s_spareDescriptors;
+    if (limit.rlim_cur < wanted)
+    {
+        limit.rlim_cur = std::min(wanted, limit.rlim_max);
+        ::setrlimit(RLIMIT_NOFILE, &limit);
+        ::getrlimit(RLIMIT_NOFILE, &limit);
+    }
+    if (limit.rlim_cur >= wanted)
+        return connections;
+    return std::max(1, int((limit.rlim_cur - s_spareDescriptors) / 2));
+}
+
+int connectClient(const quint16 port)
+{
+    const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+    sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+    {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool sendAll(const int fd, const QByteArray &data)
+{
+    qsizetype sent {0};
+    while (sent < data.size())
+    {
+        const ssize_t n = ::send(fd, data.constData() + sent, size_t(data.size() - sent), MSG_NOSIGNAL);
+        if (n <= 0)
+            return false;
+        sent += n;
+    }
+    return true;
+}
+
+QByteArray makeLine(const int client)
+{
+    return QByteArray("{\"client\": ") + QByteArray::number(client)
+           + ", \"type\": \"DATA\", \"message\": \"X:42.125000, Y:17.500000\", \"timestamp\": \"2025-05-06 06:29:51\"}\n";
+}
+
+Result run(std::unique_ptr<ReceiverBackend> backend, const int connections, const int linesPerConnection,
+           const int receiverThreads, const quint16 port)
+{
+    Result result;
+    QThread thread;
+    backend->moveToThread(&thread);
+    QObject::connect(&thread, &QThread::finished, backend.get(), &QObject::deleteLater);
+    thread.start();
+
+    QObject consumer;
+    qint64 received {0};
+    auto ring = std::make_shared<EventMessageRing>(s_ringCapacity, receiverThreads > 1 ? EventMessageRing::ProducerMode::Multi
+                                                                                         : EventMessageRing::ProducerMode::Single);
+    auto drain = [&ring, &received] {
+        ring->acknowledgeWakeup();
+        EventMessage msg;
+        while (ring->tryPop(msg))
+            ++received;
+    };
+    backend->setWorkerCount(receiverThreads);
+    backend->setMessageRing(ring, [&consumer, drain] {
+        QMetaObject::invokeMethod(&consumer, drain, Qt::QueuedConnection);
+    });
+    QObject::connect(backend.get(), &ReceiverBackend::messagesReceived, &consumer,
+                     [&received](const EventMessageBatch &batch) { received += batch.size(); }, Qt::QueuedConnection);
+
+    ReceiverBackend *receiver = backend.release();
+    if (receiver->listen(QHostAddress::LocalHost, port))
+    {
+        QElapsedTimer timer;
+        timer.start();
+        std::vector<int> sockets;
+        sockets.reserve(connections);
+        for (int i = 0; i < connections; ++i)
+        {
+            const int fd = connectClient(port);
+            if (fd < 0)
+                break;
+            sockets.push_back(fd);
+        }
+        result.connectMs = double(timer.nsecsElapsed()) / 1e6;
+
+        if (int(sockets.size()) == connections)
+        {
+            const qint64 expected = qint64(connections) * linesPerConnection;
+            timer.restart();
+            std::thread sender([&sockets, linesPerConnection] {
+                const QByteArray lines[3] = {makeLine(1), makeLine(2), makeLine(3)};
+                for (int round = 0; round < linesPerConnection; ++round)
+                    for (size_t i = 0; i < sockets.size(); ++i)
+                        sendAll(sockets[i], lines[i % 3]);
+            });
+
+            QEventLoop loop;
+            QTimer poll;
+            QObject::connect(&poll, &QTimer::timeout, &loop, [&] {
+                if (received >= expected || timer.elapsed() > s_timeoutMs)
+                    loop.quit();
+            });
+            poll.start(1);
+            loop.exec();
+            const qint64 ns = std::max<qint64>(1, timer.nsecsElapsed());
+            sender.join();
+
+            result.received = received;
+            result.ok = received == expected;
+            result.messagesPerSecond = double(received) * 1e9 / double(ns);
+        }
+
+        for (const int fd : sockets)
+            ::close(fd);
+    }
+
+    QMetaObject::invokeMethod(receiver, &ReceiverBackend::close, Qt::BlockingQueuedConnection);
+    thread.quit();
+    thread.wait();
+    return result;
+}
+
+void report(QTextStream &out, const char *name, const Result &result)
+{
+    out << name << (result.ok ? "" : "  (INCOMPLETE)") << "\n"
+        << "  connect:              " << QString::number(result.connectMs, 'f', 1) << " ms\n"
+        << "  received:             " << result.received << " messages\n"
+        << "  throughput:           " << qint64(result.messagesPerSecond) << " messages/s\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    const int requested = argc > 1 ? QByteArray(argv[1]).toInt() : 10000;
+    const int linesPerConnection = std::max(1, argc > 2 ? QByteArray(argv[2]).toInt() : 20);
+    const int receiverThreads = std::max(1, argc > 3 ? QByteArray(argv[3]).toInt() : 1);
+    const quint16 port = quint16(argc > 4 ? QByteArray(argv[4]).toUInt() : 50505);
+
+    const int connections = raiseDescriptorLimit(std::max(1, requested));
+    if (connections < requested)
+        out << "descriptor limit allows only " << connections << " connections\n";
+    out << "connections:            " << connections << "\n"
+        << "lines per connection:   " << linesPerConnection << "\n"
+        << "receiver threads:       " << receiverThreads << " (EventReceiver only)\n";
+    out.flush();
+
+    const Result qt = run(std::make_unique<EventReceiver>(), connections, linesPerConnection, receiverThreads, port);
+    report(out, "EventReceiver (QTcpServer)", qt);
+    out.flush();
+
+    const Result epoll = run(std::make_unique<EpollReceiver>(), connections, linesPerConnection, receiverThreads, port + 1);
+    report(out, "EpollReceiver (epoll)", epoll);
+
+    if (!qt.ok || !epoll.ok)
+    {
+        out << "FAIL: not every message arrived\n";
+        return 1;
+    }
+    out << "epoll / QTcpServer:     " << QString::number(epoll.messagesPerSecond / qt.messagesPerSecond, 'f', 2) << "x\n";
+    return 0;
+}
@@ -0,0 +1,268 @@
+// Compares the Writer's batched path (persistent file, LogFormatter into one
+// reused buffer, one write per batch) with the per-message path it replaced
+// (QFile opened per batch, QTextStream and QDateTime::toString per line).
+// Both write the same messages in flush sized batches into a temporary
+// directory; the numbers are lines per second until the file is complete, for
+// the Writer including its final fsync. The two files must be identical.
+// A third run writes the binary format; converted back to text it must match
+// too, and it has to be at least three times smaller than the text file. The
+// same holds when the segment is appended one or two messages at a time, as
+// the Writer sees it with a steady trickle of events. The last run writes a
+// file per module with three threads, each of which must hold exactly that
+// module's lines in order.
+//
+// Build with -DEVENTMONITOR_BUILD_BENCHMARKS=ON and run ./writer_benchmark [lines] [batchSize]
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDeadlineTimer>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <algorithm>
+#include <functional>
+
+#include "binarylog.h"
+#include "logformatter.h"
+#include "writer.h"
+
+namespace {
+
+constexpr double s_requiredLinesPerSecond {200000.0};
+constexpr double s_requiredBinaryRatio {3.0};
+
+QList<EventMessageBatch> makeBatches(const int count, const int batchSize)
+{
+    static const Severity severities[] = {Severity::Data, Severity::Data, Severity::Data,
+                                          Severity::Info, Severity::Warning, Severity::Error};
+    QList<EventMessageBatch> batches;
+    QRandomGenerator rng(42);
+    qint64 timestamp = currentTimestamp();
+    EventMessageBatch batch;
+    for (int i = 0; i < count; ++i)
+    {
+        EventMessage msg;
+        msg.timestamp = timestamp += rng.bounded(200);
+        msg.clientId = 1 + rng.bounded(3);
+        msg.severity = severities[rng.bounded(6)];
+        if (msg.severity == Severity::Data)
+            msg.text = QString("X:%1, Y:%2").arg(rng.bounded(100.0), 0, 'f', 6).arg(rng.bounded(100.0), 0, 'f', 6);
+        else
+            msg.text = QString("Value stable for last 5 samples (avg = %1)").arg(rng.bounded(100.0), 0, 'f', 2);
+        batch.append(msg);
+        if (batch.size() == batchSize)
+        {
+            batches.append(batch);
+            batch.clear();
+        }
+    }
+    if (!batch.isEmpty())
+        batches.append(batch);
+    return batches;
+}
+
+double perMessage(const QList<EventMessageBatch> &batches, const QString &path, const int lines)
+{
+    QElapsedTimer timer;
+    timer.start();
+    for (const EventMessageBatch &batch : batches)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::Append | QIODevice::Text))
+            return 0.0;
+        QTextStream out(&file);
+        for (const EventMessage &msg : batch)
+        {
+            out << timestampToDateTime(msg.timestamp).toString("yyyy-MM-dd HH:mm:ss")
+                << " Module " << msg.clientId
+                << " [" << severityName(msg.severity) << "]: "
+                << msg.text.toString() << "\n";
+        }
+    }
+    return double(lines) * 1e9 / double(std::max<qint64>(1, timer.nsecsElapsed()));
+}
+
+double batched(const QList<EventMessageBatch> &batches, const QString &path, const int lines,
+               const std::function<void(Writer &)> &configure = {})
+{
+    Writer writer;
+    writer.setLogFilePath(path);
+    if (configure)
+        configure(writer);
+    writer.start();
+
+    QElapsedTimer timer;
+    timer.start();
+    for (const EventMessageBatch &batch : batches)
+        writer.enqueue(batch);
+    quint64 unwritten {0};
+    if (!writer.sync(QDeadlineTimer(60000), unwritten))
+        return 0.0;
+    const qint64 ns = timer.nsecsElapsed();
+    writer.finish();
+    writer.wait();
+    return double(lines) * 1e9 / double(std::max<qint64>(1, ns));
+}
+
+// The messages appended to a binary segment in batches of one or two, as the
+// Writer hands them over when every flush carries only a few events
+bool trickled(const QList<EventMessageBatch> &batches, const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    BinaryLogWriter writer;
+    bool ok = writer.begin(&file);
+    EventMessageBatch small;
+    for (const EventMessageBatch &batch : batches)
+    {
+        for (const EventMessage &msg : batch)
+        {
+            small.append(msg);
+            if (small.size() == 1 + qsizetype(msg.timestamp % 2))
+            {
+                ok = writer.append(small) && ok;
+                small.clear();
+            }
+        }
+    }
+    ok = writer.append(small) && ok;
+    return writer.finish() && ok;
+}
+
+QByteArray fileHash(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return {};
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(&file);
+    return hash.result();
+}
+
+// Hash of the lines of one module, as its own log file has to hold them
+QByteArray moduleHash(const QList<EventMessageBatch> &batches, const uint32_t clientId)
+{
+    LogFormatter formatter;
+    QByteArray text;
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for (const EventMessageBatch &batch : batches)
+    {
+        text.resize(0);
+        for (const EventMessage &msg : batch)
+        {
+            if (msg.clientId == clientId)
+                formatter.append(text, msg);
+        }
+        hash.addData(text);
+    }
+    return hash.result();
+}
+
+// Hash of the text layout of a binary segment, as evlog_convert writes it
+QByteArray convertedHash(const QString &path)
+{
+    BinaryLogReader reader;
+    if (!reader.open(path) || !reader.hasFooter())
+        return {};
+    LogFormatter formatter;
+    QByteArray text;
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    EventMessageBatch block;
+    for (qsizetype i = 0; i < reader.blocks().size(); ++i)
+    {
+        if (!reader.readBlock(i, block))
+            return {};
+        text.resize(0);
+        for (const EventMessage &msg : block)
+            formatter.append(text, msg);
+        hash.addData(text);
+    }
+    return hash.result();
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    const int lineCount = std::max(1, argc > 1 ? QByteArray(argv[1]).toInt() : 500000);
+    const int batchSize = std::max(1, argc > 2 ? QByteArray(argv[2]).toInt() : 500);
+    const QList<EventMessageBatch> batches = makeBatches(lineCount, batchSize);
+
+    QTemporaryDir dir;
+    if (!dir.isValid())
+    {
+        out << "FAIL: no temporary directory\n";
+        return 1;
+    }
+    const QString legacyPath = dir.filePath("per_message.txt");
+    const QString writerPath = dir.filePath("writer.txt");
+    const QString binaryPath = dir.filePath("writer.evlog");
+    const QString trickledPath = dir.filePath("trickled.evlog");
+
+    const double legacy = perMessage(batches, legacyPath, lineCount);
+    const double writer = batched(batches, writerPath, lineCount);
+    const double binary = batched(batches, binaryPath, lineCount, [](Writer &w) { w.setBinaryFormat(true); });
+    QDir routedDir(dir.filePath("routed"));
+    routedDir.mkpath(".");
+    const double routed = batched(batches, routedDir.filePath("routed.txt"), lineCount, [](Writer &w) {
+        w.setRouting(true);
+        w.setThreadCount(3);
+    });
+    const bool trickleWritten = trickled(batches, trickledPath);
+    const double ratio = double(QFileInfo(writerPath).size()) / double(std::max<qint64>(1, QFileInfo(binaryPath).size()));
+    const double trickleRatio = double(QFileInfo(writerPath).size()) / double(std::max<qint64>(1, QFileInfo(trickledPath).size()));
+
+    out << "lines:                  " << lineCount << " in batches of " << batchSize << "\n"
+        << "per message:            " << qint64(legacy) << " lines/s\n"
+        << "Writer:                 " << qint64(writer) << " lines/s\n"
+        << "speedup:                " << QString::number(writer / std::max(1.0, legacy), 'f', 2) << "x\n"
+        << "Writer, binary:         " << qint64(binary) << " lines/s\n"
+        << "binary size:            " << QString::number(ratio, 'f', 2) << "x smaller\n"
+        << "binary, 1-2 per append: " << QString::number(trickleRatio, 'f', 2) << "x smaller\n"
+        << "Writer, per module:     " << qint64(routed) << " lines/s, 3 threads\n";
+
+    if (fileHash(legacyPath) != fileHash(writerPath))
+    {
+        out << "FAIL: the log files differ\n";
+        return 1;
+    }
+    if (fileHash(legacyPath) != convertedHash(binaryPath))
+    {
+        out << "FAIL: the converted binary log differs\n";
+        return 1;
+    }
+    if (!trickleWritten || fileHash(legacyPath) != convertedHash(trickledPath))
+    {
+        out << "FAIL: the binary log written in small batches differs\n";
+        return 1;
+    }
+    for (uint32_t clientId = 1; clientId <= 3; ++clientId)
+    {
+        const QStringList files = routedDir.entryList({QString("logger_*_module%1.txt").arg(clientId)}, QDir::Files);
+        if (files.size() != 1 || fileHash(routedDir.filePath(files.first())) != moduleHash(batches, clientId))
+        {
+            out << "FAIL: the log file of module " << clientId << " differs\n";
+            return 1;
+        }
+    }
+    if (writer < s_requiredLinesPerSecond)
+    {
+        out << "FAIL: expected at least " << qint64(s_requiredLinesPerSecond) << " lines/s\n";
+        return 1;
+    }
+    if (std::min(ratio, trickleRatio) < s_requiredBinaryRatio)
+    {
+        out << "FAIL: expected the binary log to be at least " << s_requiredBinaryRatio << "x smaller\n";
+        return 1;
+    }
+    out << "PASS\n";
+    return 0;
+}
@@ -0,0 +1,397 @@
+#include "binarylog.h"
+#include <QDebug>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+
+namespace {
+constexpr char s_fileMagic[8] {'E', 'V', 'L', 'O', 'G', 'B', 'N', '1'};
+constexpr char s_indexMagic[8] {'E', 'V', 'L', 'O', 'G', 'I', 'D', 'X'};
+constexpr uint32_t s_version {1};
+constexpr uint32_t s_blockMagic {0x4B425645};   // "EVBK"
+constexpr uint32_t s_compressedFlag {0x1};
+constexpr qsizetype s_minCompressSize {256};
+constexpr int s_compressionLevel {1};           // the Writer's thread pays for it, speed over ratio
+constexpr qsizetype s_recordHeaderSize {20};    // timestamp, client, length, severity, 3 reserved
+constexpr qsizetype s_indexEntrySize {32};      // offset, min and max timestamp, count, reserved
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    qint64 created;
+};
+static_assert(sizeof(FileHeader) == 24);
+
+struct BlockHeader {
+    uint32_t magic;
+    uint32_t flags;
+    uint32_t storedSize;    // payload bytes in the file
+    uint32_t rawSize;       // payload bytes uncompressed
+    uint32_t count;
+    uint32_t crc;           // CRC-32 of this header with crc = 0, then the stored payload
+    qint64 minTimestamp;
+    qint64 maxTimestamp;
+};
+static_assert(sizeof(BlockHeader) == 40);
+
+struct Trailer {
+    qint64 indexOffset;
+    uint32_t count;
+    uint32_t crc;           // CRC-32 of the index entries
+    char magic[8];
+};
+static_assert(sizeof(Trailer) == 24);
+
+constexpr std::array<uint32_t, 256> makeCrcTable()
+{
+    std::array<uint32_t, 256> table {};
+    for (uint32_t i = 0; i < 256; ++i)
+    {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit)
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+        table[i] = crc;
+    }
+    return table;
+}
+constexpr std::array<uint32_t, 256> s_crcTable = makeCrcTable();
+
+// CRC-32 (IEEE), continued from crc
+uint32_t crc32(uint32_t crc, const void *data, const qsizetype size)
+{
+    const auto *bytes = static_cast<const uchar *>(data);
+    crc = ~crc;
+    for (qsizetype i = 0; i < size; ++i)
+        crc = s_crcTable[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+uint32_t blockCrc(BlockHeader header, const char *payload, const qsizetype size)
+{
+    header.crc = 0;
+    return crc32(crc32(0, &header, sizeof(header)), payload, size);
+}
+
+template<class T>
+void appendValue(QByteArray &out, const T value)
+{
+    out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+template<class T>
+T readValue(const char *p)
+{
+    T value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+}
+
+bool BinaryLogWriter::begin(QIODevice *device)
+{
+    m_device = device;
+    m_index.clear();
+    m_openCount = 0;
+    FileHeader header {};
+    std::memcpy(header.magic, s_fileMagic, sizeof(s_fileMagic));
+    header.version = s_version;
+    header.created = currentTimestamp();
+    m_offset = sizeof(header);
+    return m_device->write(reinterpret_cast<const char *>(&header), sizeof(header)) == qint64(sizeof(header));
+}
+
+bool BinaryLogWriter::append(const EventMessageBatch &batch)
+{
+    bool ok {true};
+    for (const EventMessage &msg : batch)
+    {
+        appendRecord(msg);
+        if (m_openCount >= BlockRecords || m_raw.size() >= BlockBytes)
+            ok = flush() && ok;
+    }
+    if (openBlockExpired())
+        ok = flush() && ok;
+    return ok;
+}
+
+bool BinaryLogWriter::hasOpenBlock() const
+{
+    return m_openCount > 0;
+}
+
+bool BinaryLogWriter::openBlockExpired() const
+{
+    return m_openCount > 0 && m_openAge.hasExpired(BlockAgeMs);
+}
+
+bool BinaryLogWriter::finish()
+{
+    static_assert(sizeof(IndexEntry) == s_indexEntrySize);
+    if (!m_device)
+        return false;
+    const bool flushed = flush();
+
+    QByteArray footer;
+    footer.reserve(m_index.size() * s_indexEntrySize + qsizetype(sizeof(Trailer)));
+    footer.append(reinterpret_cast<const char *>(m_index.constData()), m_index.size() * s_indexEntrySize);
+    Trailer trailer {};
+    trailer.indexOffset = m_offset;
+    trailer.count = uint32_t(m_index.size());
+    trailer.crc = crc32(0, footer.constData(), footer.size());
+    std::memcpy(trailer.magic, s_indexMagic, sizeof(s_indexMagic));
+    appendValue(footer, trailer);
+
+    const bool ok = m_device->write(footer) == footer.size() && flushed;
+    m_device = nullptr;
+    m_index.clear();
+    return ok;
+}
+
+bool BinaryLogWriter::isActive() const
+{
+    return m_device != nullptr;
+}
+
+qint64 BinaryLogWriter::size() const
+{
+    return m_offset;
+}
+
+void BinaryLogWriter::appendRecord(const EventMessage &msg)
+{
+    if (m_openCount == 0)
+    {
+        m_raw.resize(0);
+        m_openMinTimestamp = std::numeric_limits<qint64>::max();
+        m_openMaxTimestamp = std::numeric_limits<qint64>::min();
+        m_openAge.start();
+    }
+    const QByteArrayView text = msg.text.utf8();
+    appendValue(m_raw, msg.timestamp);
+    appendValue(m_raw, msg.clientId);
+    appendValue(m_raw, uint32_t(text.size()));
+    const char severity[4] {char(msg.severity), 0, 0, 0};
+    m_raw.append(severity, sizeof(severity));
+    m_raw.append(text.data(), text.size());
+    m_openMinTimestamp = std::min(m_openMinTimestamp, msg.timestamp);
+    m_openMaxTimestamp = std::max(m_openMaxTimestamp, msg.timestamp);
+    ++m_openCount;
+}
+
+bool BinaryLogWriter::flush()
+{
+    if (!m_device || m_openCount == 0)
+        return true;
+
+    BlockHeader header {};
+    header.magic = s_blockMagic;
+    header.count = m_openCount;
+    header.minTimestamp = m_openMinTimestamp;
+    header.maxTimestamp = m_openMaxTimestamp;
+    m_openCount = 0;
+
+    QByteArray packed;
+    if (m_raw.size() >= s_minCompressSize)
+        packed = qCompress(m_raw, s_compressionLevel);
+    const bool compressed = !packed.isEmpty() && packed.size() < m_raw.size();
+    const QByteArray &stored = compressed ? packed : m_raw;
+    header.flags = compressed ? s_compressedFlag : 0;
+    header.storedSize = uint32_t(stored.size());
+    header.rawSize = uint32_t(m_raw.size());
+    header.crc = blockCrc(header, stored.constData(), stored.size());
+
+    m_block.resize(0);
+    appendValue(m_block, header);
+    m_block.append(stored);
+    if (m_device->write(m_block) != m_block.size())
+        return false;
+
+    m_index.append({m_offset, header.minTimestamp, header.maxTimestamp, header.count, 0});
+    m_offset += m_block.size();
+    return true;
+}
+
+bool BinaryLogReader::open(const QString &path)
+{
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly))
+    {
+        m_error = m_file.errorString();
+        return false;
+    }
+
+    FileHeader header {};
+    if (m_file.read(reinterpret_cast<char *>(&header), sizeof(header)) != qint64(sizeof(header))
+        || std::memcmp(header.magic, s_fileMagic, sizeof(s_fileMagic)) != 0 || header.version != s_version)
+    {
+        m_error = QString("%1 is not a binary log segment").arg(path);
+        m_file.close();
+        return false;
+    }
+
+    m_hasFooter = readFooter();
+    if (!m_hasFooter)
+        scanBlocks();
+    return true;
+}
+
+void BinaryLogReader::close()
+{
+    m_file.close();
+    m_blocks.clear();
+    m_error.clear();
+    m_hasFooter = false;
+}
+
+QString BinaryLogReader::errorString() const
+{
+    return m_error;
+}
+
+bool BinaryLogReader::hasFooter() const
+{
+    return m_hasFooter;
+}
+
+const QList<BinaryLogReader::Block> &BinaryLogReader::blocks() const
+{
+    return m_blocks;
+}
+
+quint64 BinaryLogReader::messageCount() const
+{
+    quint64 count {0};
+    for (const Block &block : m_blocks)
+        count += block.count;
+    return count;
+}
+
+bool BinaryLogReader::readBlock(const qsizetype index, EventMessageBatch &messages)
+{
+    messages.clear();
+    if (index < 0 || index >= m_blocks.size())
+        return false;
+
+    BlockHeader header {};
+    if (!m_file.seek(m_blocks[index].offset)
+        || m_file.read(reinterpret_cast<char *>(&header), sizeof(header)) != qint64(sizeof(header))
+        || header.magic != s_blockMagic)
+    {
+        m_error = QString("Damaged block header at offset %1").arg(m_blocks[index].offset);
+        return false;
+    }
+    const QByteArray stored = m_file.read(header.storedSize);
+    if (stored.size() != qsizetype(header.storedSize) || blockCrc(header, stored.constData(), stored.size()) != header.crc)
+    {
+        m_error = QString("CRC mismatch in the block at offset %1").arg(m_blocks[index].offset);
+        return false;
+    }
+    const QByteArray raw = (header.flags & s_compressedFlag) ? qUncompress(stored) : stored;
+    if (raw.size() != qsizetype(header.rawSize))
+    {
+        m_error = QString("Cannot decompress the block at offset %1").arg(m_blocks[index].offset);
+        return false;
+    }
+
+    messages.reserve(header.count);
+    const char *p = raw.constData();
+    const char *end = p + raw.size();
+    for (uint32_t i = 0; i < header.count; ++i)
+    {
+        if (end - p < s_recordHeaderSize)
+            break;
+        EventMessage msg;
+        msg.timestamp = readValue<qint64>(p);
+        msg.clientId = readValue<uint32_t>(p + 8);
+        const uint32_t length = readValue<uint32_t>(p + 12);
+        msg.severity = static_cast<Severity>(std::min<int>(uchar(p[16]), SeverityCount - 1));
+        p += s_recordHeaderSize;
+        if (end - p < qsizetype(length))
+            break;
+        msg.text = MessageText::fromUtf8(QByteArrayView(p, length));
+        p += length;
+        messages.append(std::move(msg));
+    }
+    if (messages.size() != qsizetype(header.count))
+    {
+        m_error = QString("Truncated records in the block at offset %1").arg(m_blocks[index].offset);
+        return false;
+    }
+    return true;
+}
+
+bool BinaryLogReader::read(const qint64 from, const qint64 to, const std::function<void(const EventMessage &)> &visit)
+{
+    bool ok {true};
+    EventMessageBatch messages;
+    for (qsizetype i = 0; i < m_blocks.size(); ++i)
+    {
+        // the index answers which blocks to read, everything else is skipped without I/O
+        if (m_blocks[i].maxTimestamp < from || m_blocks[i].minTimestamp > to)
+            continue;
+        if (!readBlock(i, messages))
+        {
+            ok = false;
+            continue;
+        }
+        for (const EventMessage &msg : messages)
+        {
+            if (msg.timestamp >= from && msg.timestamp <= to)
+                visit(msg);
+        }
+    }
+    return ok;
+}
+
+bool BinaryLogReader::readFooter()
+{
+    const qint64 size = m_file.size();
+    Trailer trailer {};
+    if (size < qint64(sizeof(FileHeader) + sizeof(Trailer)) || !m_file.seek(size - qint64(sizeof(Trailer)))
+        || m_file.read(reinterpret_cast<char *>(&trailer), sizeof(trailer)) != qint64(sizeof(trailer))
+        || std::memcmp(trailer.magic, s_indexMagic, sizeof(s_indexMagic)) != 0)
+        return false;
+
+    const qint64 indexSize = qint64(trailer.count) * s_indexEntrySize;
+    if (trailer.indexOffset < qint64(sizeof(FileHeader)) || trailer.indexOffset + indexSize + qint64(sizeof(Trailer)) != size
+        || !m_file.seek(trailer.indexOffset))
+        return false;
+    const QByteArray index = m_file.read(indexSize);
+    if (index.size() != indexSize || crc32(0, index.constData(), index.size()) != trailer.crc)
+        return false;
+
+    m_blocks.reserve(trailer.count);
+    for (uint32_t i = 0; i < trailer.count; ++i)
+    {
+        const char *entry = index.constData() + qsizetype(i) * s_indexEntrySize;
+        m_blocks.append({readValue<qint64>(entry), readValue<qint64>(entry + 8),
+                         readValue<qint64>(entry + 16), readValue<quint32>(entry + 24)});
+    }
+    return true;
+}
+
+// Rebuilds the index of a segment that was not closed, up to the first damaged block
+void BinaryLogReader::scanBlocks()
+{
+    m_blocks.clear();
+    const qint64 size = m_file.size();
+    qint64 offset = sizeof(FileHeader);
+    BlockHeader header {};
+    while (offset + qint64(sizeof(header)) <= size && m_file.seek(offset)
+           && m_file.read(reinterpret_cast<char *>(&header), sizeof(header)) == qint64(sizeof(header))
+           && header.magic == s_blockMagic
+           && qint64(header.storedSize) <= size - offset - qint64(sizeof(header)))
+    {
+        const QByteArray stored = m_file.read(header.storedSize);
+        if (stored.size() != qsizetype(header.storedSize) || blockCrc(header, stored.constData(), stored.size()) != header.crc)
+            break;
+        m_blocks.append({offset, header.minTimestamp, header.maxTimestamp, header.count});
+        offset += qint64(sizeof(header)) + header.storedSize;
+    }
+    if (offset < size)
+        qWarning() << "Binary log" << m_file.fileName() << "has no index, recovered" << m_blocks.size()
+                   << "blocks, ignoring" << size - offset << "bytes after them";
+}
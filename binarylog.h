@@ -0,0 +1,125 @@
+#ifndef BINARYLOG_H
+#define BINARYLOG_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QIODevice>
+#include <QList>
+#include <QString>
+#include <functional>
+#include "eventmessage.h"
+
+// Binary log segments (.evlog), the compact alternative to the text layout.
+//
+// A segment is a 24 byte file header, a sequence of blocks and, once the
+// segment is closed, an index footer. A block is a 40 byte header (stored and
+// raw size, record count, the smallest and largest timestamp, flags and a
+// CRC-32 over header and payload) followed by its records, qCompress()ed when
+// that is smaller. A record is a fixed 20 byte header (int64 timestamp, client,
+// text length, severity) followed by the UTF-8 text.
+// The footer is the sparse time index, one entry per block with its offset and
+// time span, closed by a trailer with the index position and its own CRC-32.
+// A segment without a valid footer (the Writer was killed) is indexed by
+// walking the blocks and stops at the first damaged one.
+// Block and index are written in one piece each; integers are in the byte order
+// of the machine, as in the spill file.
+// The Writer's batches are often only a message or two, so the writer keeps one
+// block open across append() calls and writes it once it holds BlockRecords
+// messages or BlockBytes of records, once it is BlockAgeMs old, or on flush()
+// and finish(). Until then its messages exist in memory only.
+
+// Encodes batches into blocks on a device the caller opened (and closes)
+class BinaryLogWriter
+{
+public:
+    static constexpr qsizetype BlockRecords {4096};
+    static constexpr qsizetype BlockBytes {256 * 1024};
+    static constexpr qint64 BlockAgeMs {1000};
+
+    BinaryLogWriter() = default;
+
+    BinaryLogWriter(const BinaryLogWriter&) = delete;
+    BinaryLogWriter& operator=(const BinaryLogWriter&) = delete;
+
+    // Writes the file header, device must be empty
+    bool begin(QIODevice *device);
+    // Adds to the open block, writing it (in a single write) once it is full or old enough
+    bool append(const EventMessageBatch &batch);
+    // Writes the open block, if any
+    bool flush();
+    bool hasOpenBlock() const;
+    // The open block is BlockAgeMs old
+    bool openBlockExpired() const;
+    // Writes the open block and the index footer and detaches from the device
+    bool finish();
+    bool isActive() const;
+    // Bytes written to the segment so far
+    qint64 size() const;
+
+private:
+    void appendRecord(const EventMessage &msg);
+
+private:
+    struct IndexEntry {
+        qint64 offset;
+        qint64 minTimestamp;
+        qint64 maxTimestamp;
+        quint32 count;
+        quint32 reserved;
+    };
+
+    QIODevice *m_device {nullptr};
+    qint64 m_offset {0};
+    QByteArray m_raw;           // records of the open block
+    quint32 m_openCount {0};
+    qint64 m_openMinTimestamp {0};
+    qint64 m_openMaxTimestamp {0};
+    QElapsedTimer m_openAge;
+    QByteArray m_block;
+    QList<IndexEntry> m_index;
+};
+
+// Random access to a segment through its index: range queries only read the
+// blocks whose time span overlaps the range.
+class BinaryLogReader
+{
+public:
+    struct Block {
+        qint64 offset {0};
+        qint64 minTimestamp {0};
+        qint64 maxTimestamp {0};
+        quint32 count {0};
+    };
+
+    BinaryLogReader() = default;
+
+    BinaryLogReader(const BinaryLogReader&) = delete;
+    BinaryLogReader& operator=(const BinaryLogReader&) = delete;
+
+    bool open(const QString &path);
+    void close();
+    QString errorString() const;
+
+    // False when the index had to be rebuilt by walking the blocks
+    bool hasFooter() const;
+    const QList<Block> &blocks() const;
+    quint64 messageCount() const;
+
+    // Checks the CRC, false for a damaged block
+    bool readBlock(const qsizetype index, EventMessageBatch &messages);
+    // Every message with from <= timestamp <= to, in file order
+    bool read(const qint64 from, const qint64 to, const std::function<void(const EventMessage &)> &visit);
+
+private:
+    bool readFooter();
+    void scanBlocks();
+
+private:
+    QFile m_file;
+    QList<Block> m_blocks;
+    QString m_error;
+    bool m_hasFooter {false};
+};
+
+#endif // BINARYLOG_H
@@ -1,35 +1,82 @@
 #include "controller.h"
 #include <QMetaObject>
 #include "settings.h"
+#include "eventreceiver.h"
+#ifdef EVENTMONITOR_HAS_EPOLL
+#include "epollreceiver.h"
+#endif
 #include <QDebug>
 #include <QRegularExpression>
+#include <algorithm>
 
 namespace {
-    constexpr uint32_t s_numberOfModules = 3U;
     constexpr uint32_t s_criticalModule = 3U;
-    static std::array<bool, s_numberOfModules> s_moduleStopped { false, false, false };
+    constexpr size_t s_messageRingCapacity = 4096U;
+    constexpr int s_displayInterval = 50;
+    // by the index of the Writer Queue Full choice in the settings dialog
+    constexpr SinkDropPolicy s_writerFullPolicies[] = {SinkDropPolicy::Block, SinkDropPolicy::DropBySeverity,
+                                                       SinkDropPolicy::Spill};
+
+    // EVENTMONITOR_RECEIVER_BACKEND=epoll selects the epoll ingest backend where it is available
+    std::unique_ptr<ReceiverBackend> createReceiverBackend()
+    {
+#ifdef EVENTMONITOR_HAS_EPOLL
+        if (qEnvironmentVariable("EVENTMONITOR_RECEIVER_BACKEND") == QLatin1String("epoll"))
+            return std::make_unique<EpollReceiver>();
+#endif
+        return std::make_unique<EventReceiver>();
+    }
 }
 
 
 Controller::Controller(QObject *parent)
     : QObject{parent},
-    m_logger{std::make_unique<Logger>(this)},
-    m_receiver{std::make_unique<EventReceiver>()},
+    m_logger{std::make_unique<Logger>()},
+    m_loggerThread{std::make_unique<QThread>(this)},
+    m_receiver{createReceiverBackend()},
     m_receiverThread{std::make_unique<QThread>(this)},
     m_pythonProcessManager{std::make_unique<PythonProcessManager>(this)},
     m_ipAddress{"127.0.0.1"},
     m_localPort(1024)
 {
     m_receiver->moveToThread(m_receiverThread.get());
+    m_logger->moveToThread(m_loggerThread.get());
 
-    connect(m_receiver.get(), &EventReceiver::messageReceived, this, &Controller::handleMessage, Qt::QueuedConnection);
+    connect(m_receiver.get(), &ReceiverBackend::messagesReceived, m_logger.get(), &Logger::ingestMessages, Qt::QueuedConnection);
     connect(m_receiverThread.get(), &QThread::finished, m_receiver.get(), &QObject::deleteLater);
     connect(m_receiver.get(), &QObject::destroyed, this, [this]() {
         m_receiver.release();
         m_receiver = nullptr;
     });
 
-    connect(m_logger.get(), &Logger::messageReady, this, &Controller::displayMessage);
+    connect(m_loggerThread.get(), &QThread::finished, m_logger.get(), &QObject::deleteLater);
+    connect(m_logger.get(), &Logger::messagesIngested, this, &Controller::handleMessages);
+    connect(m_logger.get(), &Logger::readingResumed, this, [this]() {
+        if (m_receiver)
+            m_receiver->resumeReading();
+    });
+    connect(m_logger.get(), &Logger::flushedAfterStop, this, [this](const DrainReport &report) {
+        showPendingMessages();
+        emit systemMessage(QString("%1 messages flushed in %2 ms, log file %3.\n")
+                               .arg(report.flushed).arg(report.elapsedMs)
+                               .arg(report.synced ? "synced to disk" : "not synced"));
+        if (report.abandoned > 0 || report.unwritten > 0)
+            emit systemMessage(QString("Shutdown deadline reached: %1 buffered messages abandoned, %2 not written.\n")
+                                   .arg(report.abandoned).arg(report.unwritten));
+        if (report.spilled > 0)
+            emit systemMessage(QString("%1 messages stay in the spill file for the next log file.\n").arg(report.spilled));
+        emit systemMessage("Application stopped.\n");
+        emit loggerFlushedAfterStop();
+    });
+
+    // The GUI picks the flushed messages up at most every s_displayInterval ms
+    m_displayTimer.setSingleShot(true);
+    m_displayTimer.setInterval(s_displayInterval);
+    connect(&m_displayTimer, &QTimer::timeout, this, &Controller::showPendingMessages);
+    connect(m_logger.get(), &Logger::displayReady, this, [this]() {
+        if (!m_displayTimer.isActive())
+            m_displayTimer.start();
+    });
     connect(m_pythonProcessManager.get(), &PythonProcessManager::triggerOutput,
             this, &Controller::handleTriggerOutput);
     connect(m_pythonProcessManager.get(), &PythonProcessManager::triggerError,
@@ -40,12 +87,13 @@ Controller::Controller(QObject *parent)
             this, &Controller::handleTriggerFinished);
 
      m_receiverThread->start();
+     m_loggerThread->start();
 }
 
 Controller::~Controller()
 {
     if (m_receiver) {
-        QMetaObject::invokeMethod(m_receiver.get(), &EventReceiver::close, Qt::BlockingQueuedConnection);
+        QMetaObject::invokeMethod(m_receiver.get(), &ReceiverBackend::close, Qt::BlockingQueuedConnection);
         QMetaObject::invokeMethod(m_receiver.get(), "deleteLater", Qt::QueuedConnection);
         m_receiver.release();
     }
@@ -54,6 +102,11 @@ Controller::~Controller()
         m_receiverThread->quit();
         m_receiverThread->wait();
     }
+
+    // The Logger and its Writer are deleted on the logger thread when it finishes
+    m_logger.release();
+    m_loggerThread->quit();
+    m_loggerThread->wait();
 }
 
 bool Controller::startModules()
@@ -61,9 +114,9 @@ bool Controller::startModules()
     bool isReceiverNew {false};
     if (!m_receiver)
     {
-        m_receiver = std::make_unique<EventReceiver>();
+        m_receiver = createReceiverBackend();
         isReceiverNew = true;
-        connect(m_receiver.get(), &EventReceiver::messageReceived, this, &Controller::handleMessage);
+        connect(m_receiver.get(), &ReceiverBackend::messagesReceived, m_logger.get(), &Logger::ingestMessages);
         connect(m_receiver.get(), &QObject::destroyed, this, [this]() {
             m_receiver.release();
             m_receiver = nullptr;
@@ -82,11 +135,14 @@ bool Controller::startModules()
     }
 
     if (!m_receiver->isListening()) {
+        m_receiver->setFlowControl(m_logger->flowControl());
+        attachMessageRing();
         if (m_receiver->listen(QHostAddress{m_ipAddress}, m_localPort)) {
-            m_logger->startNewLogFile();
+            QMetaObject::invokeMethod(m_logger.get(), &Logger::startNewLogFile, Qt::QueuedConnection);
             emit systemMessage(QString("Server started on port %1\n").arg(m_localPort));
             emit modulesStarted();
-            s_moduleStopped = {false, false, false};
+            setAllModulesStopped(false);
+            m_expectedModuleCount = m_simulatedModuleCount;
             QTimer::singleShot(1000, this, &Controller::startPythonProcess);
             return true;
         }
@@ -110,20 +166,30 @@ bool Controller::stopApplication()
         shutdownReceiverSoft();
     }
 
-    s_moduleStopped = {true, true, true};
+    setAllModulesStopped(true);
     flushLoggerAfterAppStop("Application stopped by user. Flushing remaining messages...\n");
     return true;
 }
 
 void Controller::stopModule(const int clientId, const bool logMessage)
 {
+    const int index = m_modules.indexOf(clientId);
+    if (index == ModuleRegistry::InvalidIndex)
+        return;
+
     if (m_receiver->isListening()) {
         m_receiver->stopClient(clientId);
-        m_logger->logManualStop(clientId);
-        s_moduleStopped[clientId -1] = true;
-        if (s_moduleStopped[0] && s_moduleStopped[1] && s_moduleStopped[2]) {
+        QMetaObject::invokeMethod(m_logger.get(), [logger = m_logger.get(), clientId]() {
+            logger->logManualStop(clientId);
+        }, Qt::QueuedConnection);
+        if (!m_moduleStopped[index]) {
+            m_moduleStopped[index] = true;
+            ++m_stoppedModuleCount;
+        }
+        // modules that have not connected yet count as running, so stopping the
+        // first ones to register does not end the session
+        if (m_stoppedModuleCount >= std::max(m_modules.size(), m_expectedModuleCount)) {
             shutdownReceiverSoft();
-            m_logger->applyFlushIntervalAfterAppStopped();
             emit moduleStopped(clientId, logMessage, true);
             flushLoggerAfterAppStop("The other modules are already stopped so the logger is stopping...\n");
             return;
@@ -134,7 +200,7 @@ void Controller::stopModule(const int clientId, const bool logMessage)
 
 void Controller::startPythonProcess()
 {
-    m_pythonProcessManager->start(m_ipAddress, m_localPort);
+    m_pythonProcessManager->start(m_ipAddress, m_localPort, m_simulatedModuleCount);
 }
 
 void Controller::killPythonProcess()
@@ -162,30 +228,103 @@ void Controller::handleTriggerFinished(int exitCode)
     qDebug() << "Python process finished with exit code:" << exitCode;
 }
 
+void Controller::handleMessages(const EventMessageBatch &batch)
+{
+    for (const EventMessage &msg : batch)
+        handleMessage(msg);
+}
+
+void Controller::showPendingMessages()
+{
+    m_displayTimer.stop();
+    quint64 skipped {0};
+    const EventMessageBatch batch = m_logger->displaySink()->take(skipped);
+    if (skipped > 0)
+        emit systemMessage(QString("%1 messages were not displayed to keep up, they are in the log file\n").arg(skipped));
+    if (!batch.isEmpty())
+        emit displayMessages(batch);
+}
+
+void Controller::attachMessageRing()
+{
+    // One receiver thread can use the cheaper single producer ring
+    const auto mode = m_receiverThreadCount > 1 ? EventMessageRing::ProducerMode::Multi
+                                                : EventMessageRing::ProducerMode::Single;
+    if (!m_messageRing || m_messageRing->producerMode() != mode)
+    {
+        // The Logger drains the previous ring before it switches over
+        m_messageRing = std::make_shared<EventMessageRing>(s_messageRingCapacity, mode);
+        QMetaObject::invokeMethod(m_logger.get(), [logger = m_logger.get(), ring = m_messageRing]() {
+            logger->setMessageRing(ring);
+        }, Qt::QueuedConnection);
+    }
+
+    // The receiver is idle here, listen() hands both over to its thread.
+    // Wakeups are queued behind setMessageRing() on the logger thread.
+    m_receiver->setWorkerCount(m_receiverThreadCount);
+    m_receiver->setMessageRing(m_messageRing, [logger = m_logger.get()]() {
+        QMetaObject::invokeMethod(logger, &Logger::drainMessageRing, Qt::QueuedConnection);
+    });
+}
+
+void Controller::applyLoggerSettings()
+{
+    QMetaObject::invokeMethod(m_logger.get(), [logger = m_logger.get(), settings = m_loggerSettings]() {
+        logger->applySettings(settings);
+    }, Qt::QueuedConnection);
+}
+
+int Controller::ensureModule(const uint32_t clientId)
+{
+    const int known = m_modules.indexOf(clientId);
+    if (known != ModuleRegistry::InvalidIndex)
+        return known;
+
+    bool added {false};
+    const int index = m_modules.registerModule(clientId, &added);
+    if (added)
+    {
+        m_processors.push_back(m_processorDefaults);
+        m_moduleStopped.push_back(false);
+        emit moduleRegistered(index, clientId);
+    }
+    return index;
+}
+
+void Controller::setAllModulesStopped(const bool stopped)
+{
+    std::fill(m_moduleStopped.begin(), m_moduleStopped.end(), stopped);
+    m_stoppedModuleCount = stopped ? m_modules.size() : 0;
+}
+
 void Controller::handleMessage(const EventMessage & msg)
 {
-    m_logger->addMessage(msg);
+    // Warnings about corrupted lines carry no valid module id
+    const int index = ensureModule(msg.clientId);
+    if (index == ModuleRegistry::InvalidIndex)
+        return;
 
-    if (msg.type == "CRITICAL") {
+    if (msg.severity == Severity::Critical) {
         if (msg.clientId == s_criticalModule) {
             shutdownReceiverHard();
-            s_moduleStopped = {true, true, true};
+            setAllModulesStopped(true);
             flushLoggerAfterAppStop("CRITICAL message received from module 3. Logger auto-stopped.\n");
             emit newMessage(msg.clientId, MessageType::CRITICAL);
         }
         else{
             stopModule(msg.clientId, false);
         }
-    } else if (msg.type == "ERROR") {
+    } else if (msg.severity == Severity::Error) {
         emit newMessage(msg.clientId, MessageType::ERROR);
-    } else if  (msg.type == "DATA") {
-        qDebug() << "Received DATA:" << msg.text << "from client" << msg.clientId;
+    } else if  (msg.severity == Severity::Data) {
+        const QString text = msg.text.toString();
+        qDebug() << "Received DATA:" << text << "from client" << msg.clientId;
         QRegularExpression regex("X:(\\d+\\.\\d+),\\s*Y:(\\d+\\.\\d+)");
-        QRegularExpressionMatch match = regex.match(msg.text);
+        QRegularExpressionMatch match = regex.match(text);
         if (match.hasMatch()) {
             double valueX = match.captured(1).toDouble();
             double valueY = match.captured(2).toDouble();
-            m_processors[msg.clientId - 1].addSample(valueX, valueY,  msg.timestamp);
+            m_processors[index].addSample(valueX, valueY,  msg.timestamp);
         }
     }
 }
@@ -197,17 +336,15 @@ void Controller::applySettings(const Settings & settings)
     int const windowSize = settings.getNumSamplesToAvg();
     double const plotWindowSec = settings.getPlotTime();
 
-    m_processors[0].setThresholds(lower, upper);
-    m_processors[1].setThresholds(lower, upper);
-    m_processors[2].setThresholds(lower, upper);
-
-    m_processors[0].setWindowSize(windowSize);
-    m_processors[1].setWindowSize(windowSize);
-    m_processors[2].setWindowSize(windowSize);
-
-    m_processors[0].setPlotTimeWindowSec(plotWindowSec);
-    m_processors[1].setPlotTimeWindowSec(plotWindowSec);
-    m_processors[2].setPlotTimeWindowSec(plotWindowSec);
+    m_processorDefaults.setThresholds(lower, upper);
+    m_processorDefaults.setWindowSize(windowSize);
+    m_processorDefaults.setPlotTimeWindowSec(plotWindowSec);
+    for (DataProcessor &processor : m_processors)
+    {
+        processor.setThresholds(lower, upper);
+        processor.setWindowSize(windowSize);
+        processor.setPlotTimeWindowSec(plotWindowSec);
+    }
 
     // TCP connection settings
     int const localPort = settings.getTcpPort();
@@ -215,35 +352,83 @@ void Controller::applySettings(const Settings & settings)
 
     m_localPort = localPort;
     m_ipAddress = ipAddress;
+    m_receiverThreadCount = settings.getReceiverThreadCount();
+    m_simulatedModuleCount = settings.getSimulatedModuleCount();
 
     // Logger settings
-    int const maxSize = settings.getRingBufferSize();
-    int const flushInterval = settings.getFlushInterval();
-
-    m_logger->setLoggerMaxSize(maxSize);
-    m_logger->setLoggerFlushInterval(flushInterval);
-    m_logger->applyFlushInterval();
+    m_loggerSettings.maxSize = settings.getRingBufferSize();
+    m_loggerSettings.flushInterval = settings.getFlushInterval();
+    m_loggerSettings.flowControlEnabled = settings.isFlowControlEnabled();
+    m_loggerSettings.flushBatchSize = settings.getFlushBatchSize();
+    m_loggerSettings.flushTimeBudget = settings.getFlushTimeBudget();
+    m_loggerSettings.adaptiveFlush = settings.isAdaptiveFlushEnabled();
+    m_loggerSettings.latencyTarget = settings.getLatencyTarget();
+    m_loggerSettings.fairQuantum = settings.getFairQuantum();
+    m_loggerSettings.clientWeights = settings.getModuleWeights();
+    m_loggerSettings.spillEnabled = settings.isSpillEnabled();
+    m_loggerSettings.spillSize = settings.getSpillSize();
+    m_loggerSettings.displayDecimation = settings.getDisplayDecimation();
+    m_loggerSettings.coalesceEnabled = settings.isCoalescingEnabled();
+    m_loggerSettings.coalesceWindow = settings.getCoalescingWindow();
+    m_loggerSettings.coalesceTemplates = settings.isCoalescingByTemplate();
+    m_loggerSettings.shutdownDeadline = settings.getShutdownDeadline();
+    m_loggerSettings.fsyncInterval = settings.getFsyncInterval();
+    m_loggerSettings.writerQueueSize = settings.getWriterQueueSize();
+    m_loggerSettings.writerFullPolicy = s_writerFullPolicies[std::clamp(settings.getWriterQueuePolicy(), 0, 2)];
+    m_loggerSettings.rotateSize = settings.getRotationSize();
+    m_loggerSettings.rotateInterval = settings.getRotationInterval();
+    m_loggerSettings.compressLogs = settings.isLogCompressionEnabled();
+    m_loggerSettings.keepLogFiles = settings.getRetainedFiles();
+    m_loggerSettings.keepLogSize = settings.getRetainedSize();
+    m_loggerSettings.binaryLog = settings.isBinaryLogFormat();
+    m_loggerSettings.perModuleLogs = settings.isPerModuleLogEnabled();
+    m_loggerSettings.logGroups = settings.getLogGroups();
+    m_loggerSettings.writerThreads = settings.getWriterThreadCount();
+    applyLoggerSettings();
 }
 
 void Controller::setSettingsOnDialog(Settings & settings)
 {
     // all data processors have the same parameters
-    double const lower =   m_processors[0].getLowerThreshold();
-    double const upper =   m_processors[0].getUpperThreshold();
-    int const windowSize =   m_processors[0].getWindowSize();
-    double const plotWindowSec =   m_processors[0].getPlotTimeWindow();
+    double const lower =   m_processorDefaults.getLowerThreshold();
+    double const upper =   m_processorDefaults.getUpperThreshold();
+    int const windowSize =   m_processorDefaults.getWindowSize();
+    double const plotWindowSec =   m_processorDefaults.getPlotTimeWindow();
 
     // Logger settings
-    int const ringBufferSize = m_logger->getLoggerMaxSize();
-    int const flushInterval = m_logger->getLoggerFlushInterval();
-    settings.loadSettings(m_ipAddress, m_localPort,lower, upper, plotWindowSec, windowSize, flushInterval, ringBufferSize);
+    settings.loadSettings(m_ipAddress, m_localPort,lower, upper, plotWindowSec, windowSize,
+                          m_loggerSettings.flushInterval, m_loggerSettings.maxSize);
+    settings.setReceiverThreadCount(m_receiverThreadCount);
+    settings.setSimulatedModuleCount(m_simulatedModuleCount);
+    settings.setFlowControlEnabled(m_loggerSettings.flowControlEnabled);
+    settings.setFlushBatchSize(m_loggerSettings.flushBatchSize);
+    settings.setFlushTimeBudget(m_loggerSettings.flushTimeBudget);
+    settings.setAdaptiveFlushEnabled(m_loggerSettings.adaptiveFlush);
+    settings.setLatencyTarget(m_loggerSettings.latencyTarget);
+    settings.setFairQuantum(m_loggerSettings.fairQuantum);
+    settings.setModuleWeights(m_loggerSettings.clientWeights);
+    settings.setSpillEnabled(m_loggerSettings.spillEnabled);
+    settings.setSpillSize(m_loggerSettings.spillSize);
+    settings.setDisplayDecimation(m_loggerSettings.displayDecimation);
+    settings.setCoalescing(m_loggerSettings.coalesceEnabled, m_loggerSettings.coalesceWindow,
+                           m_loggerSettings.coalesceTemplates);
+    settings.setShutdownDeadline(m_loggerSettings.shutdownDeadline);
+    settings.setFsyncInterval(m_loggerSettings.fsyncInterval);
+    const auto policy = std::find(std::begin(s_writerFullPolicies), std::end(s_writerFullPolicies),
+                                  m_loggerSettings.writerFullPolicy);
+    settings.setWriterQueue(m_loggerSettings.writerQueueSize,
+                            policy != std::end(s_writerFullPolicies) ? int(policy - std::begin(s_writerFullPolicies)) : 0);
+    settings.setRotation(m_loggerSettings.rotateSize, m_loggerSettings.rotateInterval, m_loggerSettings.compressLogs);
+    settings.setRetention(m_loggerSettings.keepLogFiles, m_loggerSettings.keepLogSize);
+    settings.setBinaryLogFormat(m_loggerSettings.binaryLog);
+    settings.setPerModuleLogs(m_loggerSettings.perModuleLogs, m_loggerSettings.logGroups, m_loggerSettings.writerThreads);
 }
 
 void Controller::shutdownReceiverSoft()
 {
     if (m_receiver)
     {
-        QMetaObject::invokeMethod(m_receiver.get(), &EventReceiver::close, Qt::BlockingQueuedConnection);
+        QMetaObject::invokeMethod(m_receiver.get(), &ReceiverBackend::close, Qt::BlockingQueuedConnection);
     }
 }
 
@@ -251,7 +436,7 @@ void Controller::shutdownReceiverHard()
 {
     if (m_receiver && m_receiverThread) {
         if (m_receiver) {
-            QMetaObject::invokeMethod(m_receiver.get(), &EventReceiver::close, Qt::QueuedConnection);
+            QMetaObject::invokeMethod(m_receiver.get(), &ReceiverBackend::close, Qt::QueuedConnection);
             QMetaObject::invokeMethod(m_receiver.get(), "deleteLater", Qt::QueuedConnection);
             m_receiver.release();
         }
@@ -266,35 +451,29 @@ void Controller::shutdownReceiverHard()
 void Controller::flushLoggerAfterAppStop(const QString & msg)
 {
     emit systemMessage(msg);
-    QTimer *flushAndExitTimer = new QTimer(this);
-    flushAndExitTimer->setInterval(m_logger->getLoggerFlushInterval());
-    m_logger->applyFlushIntervalAfterAppStopped();
-    connect(flushAndExitTimer, &QTimer::timeout, this, [this, flushAndExitTimer]() {
-        if (!m_logger->isEmpty()) {
-            m_logger->flushBuffer();  // flush one message
-        } else {
-            emit systemMessage("Application stopped.\n");
-            emit loggerFlushedAfterStop();
-            m_logger->applyFlushInterval();
-            flushAndExitTimer->stop();
-            flushAndExitTimer->deleteLater();
-        }
-    });
-    flushAndExitTimer->start();
+    // flushedAfterStop() reports back once everything is on disk or the deadline passed
+    QMetaObject::invokeMethod(m_logger.get(), [logger = m_logger.get(), deadline = m_loggerSettings.shutdownDeadline]() {
+        logger->drainForShutdown(deadline);
+    }, Qt::QueuedConnection);
     killPythonProcess();
 }
 
-QVector<QPointF> Controller::getProcessedCurve2D(const uint32_t index, QDateTime currentTime)
+LoggerStats::Snapshot Controller::loggerStats() const
+{
+    return m_logger->stats()->snapshot();
+}
+
+QVector<QPointF> Controller::getProcessedCurve2D(const uint32_t index, const qint64 currentTime)
 {
-    if (index > 2) {
+    if (index >= m_processors.size()) {
         return {};
     }
     return m_processors[index].getProcessedCurve(currentTime);
 }
 
-QVector<QVector3D> Controller::getProcessedCurve3D(const uint32_t index, QDateTime currentTime)
+QVector<QVector3D> Controller::getProcessedCurve3D(const uint32_t index, const qint64 currentTime)
 {
-    if (index > 2) {
+    if (index >= m_processors.size()) {
         return {};
     }
     return m_processors[index].getProcessedCurve3D(currentTime);
@@ -302,12 +481,12 @@ QVector<QVector3D> Controller::getProcessedCurve3D(const uint32_t index, QDateTi
 
 int Controller::getWindowSize() const
 {
-    return m_processors[0].getWindowSize();
+    return m_processorDefaults.getWindowSize();
 }
 
 double Controller::getPlotTimeWindow() const
 {
-    return m_processors[0].getPlotTimeWindow();
+    return m_processorDefaults.getPlotTimeWindow();
 }
 
 int Controller::getLocalPort() const
@@ -315,6 +494,21 @@ int Controller::getLocalPort() const
     return m_localPort;
 }
 
+int Controller::moduleCount() const
+{
+    return m_modules.size();
+}
+
+int Controller::moduleIndex(const uint32_t clientId) const
+{
+    return m_modules.indexOf(clientId);
+}
+
+uint32_t Controller::moduleId(const int index) const
+{
+    return m_modules.moduleId(index);
+}
+
 int Controller::estimateMaxOpenGLPointsPerModule() const
 {
     const double plotTimeSec = getPlotTimeWindow();
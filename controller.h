@@ -6,11 +6,14 @@
 #include <QTimer>
 #include <memory>
 
-#include "eventreceiver.h"
+#include "receiverbackend.h"
 #include "dataprocessor.h"
 #include "logger.h"
 #include "pythonprocessmanager.h"
 #include "eventmessage.h"
+#include "messagering.h"
+#include "moduleregistry.h"
+#include <vector>
 
 class Settings;
 
@@ -36,8 +39,9 @@ public:
     void setSettingsOnDialog(Settings & settings);
 
     //Data Processor setters and getters
-    QVector<QPointF> getProcessedCurve2D(const uint32_t index,QDateTime currentTime);
-    QVector<QVector3D> getProcessedCurve3D(const uint32_t index,QDateTime currentTime);
+    QVector<QPointF> getProcessedCurve2D(const uint32_t index, const qint64 currentTime);
+    QVector<QVector3D> getProcessedCurve3D(const uint32_t index, const qint64 currentTime);
+    LoggerStats::Snapshot loggerStats() const;
     double getPlotTimeWindow() const;
     int getWindowSize() const;
 
@@ -46,6 +50,11 @@ public:
     //Event Receiver setters and getters
     int getLocalPort() const;
 
+    // Modules in the order they first sent a valid message, see ModuleRegistry
+    int moduleCount() const;
+    int moduleIndex(const uint32_t clientId) const;
+    uint32_t moduleId(const int index) const;
+
     enum class MessageType
     {
         INFO = 1,
@@ -57,15 +66,17 @@ public:
 
 signals:
     void modulesStarted();
+    void moduleRegistered(const int index, const uint32_t clientId);
     void newMessage(uint32_t clientId, MessageType msgType);
     void logOutput(const EventMessage &msg);
     void moduleStopped(const int clientId, const bool logMessage, const bool stopApplication);
-    void displayMessage(const EventMessage &msg);
+    void displayMessages(const EventMessageBatch &batch);
     void systemMessage(const QString & msg);
     void loggerFlushedAfterStop();
 
 private slots:
-    void handleMessage(const EventMessage &msg);    
+    void handleMessages(const EventMessageBatch &batch);
+    void showPendingMessages();
     // Python script handling slots
     void handleTriggerOutput(const QString &line);
     void handleTriggerError(const QString &error);
@@ -76,17 +87,35 @@ private:
     void shutdownReceiverSoft();
     void shutdownReceiverHard();
     void flushLoggerAfterAppStop(const QString & msg);
+    void handleMessage(const EventMessage &msg);
+    int ensureModule(const uint32_t clientId);
+    void setAllModulesStopped(const bool stopped);
+    void attachMessageRing();
+    void applyLoggerSettings();
 
 
 private:
-    std::unique_ptr<EventReceiver> m_receiver;
+    std::unique_ptr<ReceiverBackend> m_receiver;
     std::unique_ptr<QThread> m_receiverThread;
     std::unique_ptr<Logger> m_logger;
+    std::unique_ptr<QThread> m_loggerThread;
+    LoggerSettings m_loggerSettings;
+    QTimer m_displayTimer;
     std::unique_ptr<PythonProcessManager> m_pythonProcessManager;
+    std::shared_ptr<EventMessageRing> m_messageRing;
+
+    // Per-module state, addressed by the ModuleRegistry index
+    ModuleRegistry m_modules;
+    std::vector<DataProcessor> m_processors;
+    std::vector<uint8_t> m_moduleStopped;
+    int m_stoppedModuleCount = 0;
+    int m_expectedModuleCount = 0;        // modules the simulator of this run starts
+    DataProcessor m_processorDefaults;    // settings every new module starts with
 
-    std::array<DataProcessor, 3> m_processors;
     QString m_ipAddress;
     int m_localPort = 0;
+    int m_receiverThreadCount = 2;
+    int m_simulatedModuleCount = 3;
 
 signals:
 };
@@ -45,7 +45,7 @@ double DataProcessor::getPlotTimeWindow() const
     return m_plotTimeWindowSec;
 }
 
-void DataProcessor::addSample(const double valueX, const double valueY, const QDateTime timestamp)
+void DataProcessor::addSample(const double valueX, const double valueY, const qint64 timestamp)
 {
     // Clip value to thresholds
     double const clippedValueX = qBound(m_lowerThreshold, valueX, m_upperThreshold);
@@ -65,7 +65,7 @@ void DataProcessor::addSample(const double valueX, const double valueY, const QD
     }
 }
 
-QVector<QPointF> DataProcessor::getProcessedCurve(QDateTime currentTime)
+QVector<QPointF> DataProcessor::getProcessedCurve(const qint64 currentTime)
 {
     QVector<QPointF> curve;
     QVector<double> recentValues;
@@ -75,7 +75,7 @@ QVector<QPointF> DataProcessor::getProcessedCurve(QDateTime currentTime)
     double timeAnchor {0.0};
     for (auto it = m_samples.crbegin(); it != m_samples.crend(); ++it)
     {
-        double elapsedSec = it->timestamp.msecsTo(currentTime) / 1000.0;
+        double elapsedSec = (currentTime - it->timestamp) / 1000000.0;
         if (elapsedSec > m_plotTimeWindowSec)
         {
             break;
@@ -99,7 +99,7 @@ QVector<QPointF> DataProcessor::getProcessedCurve(QDateTime currentTime)
     return curve;
 }
 
-QVector<QVector3D> DataProcessor::getProcessedCurve3D(QDateTime currentTime)
+QVector<QVector3D> DataProcessor::getProcessedCurve3D(const qint64 currentTime)
 {
     QVector<QVector3D> curve3D;
 
@@ -108,7 +108,7 @@ QVector<QVector3D> DataProcessor::getProcessedCurve3D(QDateTime currentTime)
     double timeAnchor = 0.0;
 
     for (auto it = m_samples.crbegin(); it != m_samples.crend(); ++it) {
-        double elapsedSec = it->timestamp.msecsTo(currentTime) / 1000.0;
+        double elapsedSec = (currentTime - it->timestamp) / 1000000.0;
         if (elapsedSec > m_plotTimeWindowSec)
             break;
 
@@ -3,7 +3,6 @@
 
 #include <QVector>
 #include <QVector3D>
-#include <QDateTime>
 #include <QPointF>
 
 class DataProcessor
@@ -22,14 +21,14 @@ public:
     int getWindowSize() const;
     double getPlotTimeWindow() const;
 
-    void addSample(const double valueX, const double valueY, const QDateTime timestamp);
+    void addSample(const double valueX, const double valueY, const qint64 timestamp);
 
-    QVector<QPointF> getProcessedCurve(QDateTime currentTime);
-    QVector<QVector3D> getProcessedCurve3D(QDateTime currentTime);
+    QVector<QPointF> getProcessedCurve(const qint64 currentTime);
+    QVector<QVector3D> getProcessedCurve3D(const qint64 currentTime);
 
 private:
     struct Sample {
-        QDateTime timestamp;
+        qint64 timestamp;   // microseconds since the Unix epoch
         double valueX;
         double valueY;
     };
@@ -0,0 +1,441 @@
+#include "epollreceiver.h"
+#include "threadutils.h"
+#include <QDebug>
+#include <QTimer>
+#include <QThread>
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace {
+constexpr int s_maxEventsPerPass {256};
+constexpr qsizetype s_chunkSize {64 * 1024};
+constexpr qsizetype s_minFramerSpace {512};
+// Bytes read from one connection before the others get their turn
+constexpr qsizetype s_readBudgetBytes {256 * 1024};
+}
+
+EpollReceiver::EpollReceiver(QObject *parent)
+    : ReceiverBackend(parent),
+    m_publisher{this}
+{
+    // A backed up ring counts as a closed gate as well, re-read once it drained
+    m_publisher.setOverflowDrainedHandler([this] {
+        QMetaObject::invokeMethod(this, &EpollReceiver::resumeReading, Qt::QueuedConnection);
+    });
+}
+
+EpollReceiver::~EpollReceiver()
+{
+    if (QThread::currentThread() != this->thread()) {
+        QMetaObject::invokeMethod(this, &EpollReceiver::closeImpl, Qt::BlockingQueuedConnection);
+    } else {
+        closeImpl();
+    }
+}
+
+bool EpollReceiver::listen(const QHostAddress &address, const quint16 port)
+{
+    bool success {false};
+    QMetaObject::invokeMethod(this, [this, address, port, &success] {
+        success = listenImpl(address, port);
+    }, Qt::BlockingQueuedConnection);
+    return success;
+}
+
+bool EpollReceiver::listenImpl(const QHostAddress &address, const quint16 port)
+{
+    if (m_listenFd >= 0)
+    {
+        qWarning() << "EpollReceiver::listen() called when already listening";
+        return false;
+    }
+
+    sockaddr_storage storage {};
+    socklen_t length {0};
+    const bool ipv6 = address.protocol() == QAbstractSocket::IPv6Protocol;
+    if (ipv6)
+    {
+        auto *addr6 = reinterpret_cast<sockaddr_in6*>(&storage);
+        const Q_IPV6ADDR raw = address.toIPv6Address();
+        addr6->sin6_family = AF_INET6;
+        addr6->sin6_port = htons(port);
+        std::memcpy(&addr6->sin6_addr, &raw, sizeof(raw));
+        length = sizeof(sockaddr_in6);
+    }
+    else
+    {
+        auto *addr4 = reinterpret_cast<sockaddr_in*>(&storage);
+        addr4->sin_family = AF_INET;
+        addr4->sin_port = htons(port);
+        addr4->sin_addr.s_addr = htonl(address.toIPv4Address());
+        length = sizeof(sockaddr_in);
+    }
+
+    m_listenFd = ::socket(ipv6 ? AF_INET6 : AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    const int reuse {1};
+    if (m_listenFd < 0
+        || ::setsockopt(m_listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) < 0
+        || ::bind(m_listenFd, reinterpret_cast<sockaddr*>(&storage), length) < 0
+        || ::listen(m_listenFd, SOMAXCONN) < 0)
+    {
+        qWarning() << "EpollReceiver: cannot listen on" << address << port << ":" << qt_error_string(errno);
+        closeImpl();
+        return false;
+    }
+
+    m_epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    epoll_event event {};
+    event.events = EPOLLIN | EPOLLET;
+    event.data.fd = m_listenFd;
+    if (m_epollFd < 0 || ::epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_listenFd, &event) < 0)
+    {
+        qWarning() << "EpollReceiver: cannot set up epoll:" << qt_error_string(errno);
+        closeImpl();
+        return false;
+    }
+
+    if (!m_chunk)
+        m_chunk = std::make_unique<char[]>(s_chunkSize);
+
+    // The epoll descriptor is readable as long as any registered socket has pending events
+    m_notifier = std::make_unique<QSocketNotifier>(m_epollFd, QSocketNotifier::Read, this);
+    connect(m_notifier.get(), &QSocketNotifier::activated, this, &EpollReceiver::processEvents);
+    m_listening.store(true, std::memory_order_release);
+    return true;
+}
+
+void EpollReceiver::close()
+{
+    qDebug() << "Receiver thread is quitting...";
+    invokeOnObjectThread(this, [this] {
+        closeImpl();
+    });
+}
+
+void EpollReceiver::closeImpl()
+{
+    m_notifier.reset();
+    for (auto &entry : m_connections)
+        closeConnection(*entry.second);
+    reapClosed();
+    m_backlog.clear();
+    m_clients.clear();
+
+    if (m_listenFd >= 0)
+    {
+        ::close(m_listenFd);
+        m_listenFd = -1;
+    }
+    if (m_epollFd >= 0)
+    {
+        ::close(m_epollFd);
+        m_epollFd = -1;
+    }
+    m_listening.store(false, std::memory_order_release);
+
+    // Nothing may get lost on shutdown: what does not fit into the ring goes the signal way
+    const EventMessageBatch rest = m_publisher.takeOverflow();
+    if (!rest.isEmpty())
+        emit messagesReceived(rest);
+}
+
+bool EpollReceiver::isListening() const
+{
+    return m_listening.load(std::memory_order_acquire);
+}
+
+void EpollReceiver::stopClient(uint32_t clientId)
+{
+    qDebug() << "stopClient called for" << clientId << "in thread";
+    invokeOnObjectThread(this, [this, clientId] {
+        closeClient(clientId);
+        if (!m_dispatching)
+            reapClosed();
+    });
+}
+
+void EpollReceiver::setMessageRing(std::shared_ptr<EventMessageRing> ring, std::function<void()> notifier)
+{
+    m_publisher.setRing(std::move(ring), std::move(notifier));
+}
+
+void EpollReceiver::setWorkerCount(const int workerCount)
+{
+    Q_UNUSED(workerCount);
+}
+
+void EpollReceiver::setFlowControl(std::shared_ptr<FlowControl> flowControl)
+{
+    m_flowControl = std::move(flowControl);
+}
+
+bool EpollReceiver::readingPaused() const
+{
+    return m_flowControl && m_flowControl->isEnabled()
+           && (m_flowControl->isPaused() || m_publisher.hasOverflow());
+}
+
+void EpollReceiver::resumeReading()
+{
+    // Parked connections will not see another edge for data already queued in the kernel
+    invokeOnObjectThread(this, [this] {
+        if (!m_backlog.empty())
+            scheduleBacklog();
+    });
+}
+
+void EpollReceiver::processEvents()
+{
+    std::array<epoll_event, s_maxEventsPerPass> events;
+    const int count = ::epoll_wait(m_epollFd, events.data(), s_maxEventsPerPass, 0);
+    if (count < 0)
+    {
+        if (errno != EINTR)
+            qWarning() << "epoll_wait failed:" << qt_error_string(errno);
+        return;
+    }
+
+    EventMessageBatch batch;
+    m_dispatching = true;
+    for (int i = 0; i < count; ++i)
+    {
+        const int fd = events[i].data.fd;
+        if (fd == m_listenFd)
+        {
+            acceptConnections();
+            continue;
+        }
+
+        // Errors and hang ups surface as a failing or empty read
+        const auto it = m_connections.find(fd);
+        if (it != m_connections.end() && !it->second->closing)
+            serviceConnection(*it->second, batch);
+    }
+    m_dispatching = false;
+
+    reapClosed();
+    deliver(batch);
+}
+
+void EpollReceiver::processBacklog()
+{
+    m_backlogScheduled = false;
+    std::vector<int> pending;
+    pending.swap(m_backlog);
+
+    EventMessageBatch batch;
+    m_dispatching = true;
+    for (const int fd : pending)
+    {
+        const auto it = m_connections.find(fd);
+        if (it == m_connections.end() || it->second->closing)
+            continue;
+        it->second->backlogged = false;
+        serviceConnection(*it->second, batch);
+    }
+    m_dispatching = false;
+
+    reapClosed();
+    deliver(batch);
+}
+
+void EpollReceiver::acceptConnections()
+{
+    // Edge triggered: accept until the queue is empty or no new edge will come
+    for (;;)
+    {
+        const int fd = ::accept4(m_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                qWarning() << "accept4 failed:" << qt_error_string(errno);
+            return;
+        }
+
+        epoll_event event {};
+        event.events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+        event.data.fd = fd;
+        if (::epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &event) < 0)
+        {
+            qWarning() << "epoll_ctl failed for new connection:" << qt_error_string(errno);
+            ::close(fd);
+            continue;
+        }
+
+        // Data that arrived before the registration is reported right away by epoll
+        auto connection = std::make_unique<Connection>();
+        connection->fd = fd;
+        m_connections.emplace(fd, std::move(connection));
+    }
+}
+
+void EpollReceiver::serviceConnection(Connection &connection, EventMessageBatch &batch)
+{
+    // While paused the data stays in the kernel, so the TCP window closes on the sender
+    const ReadResult result = readingPaused() ? ReadResult::Pending : readConnection(connection, batch);
+    switch (result)
+    {
+    case ReadResult::Drained:
+        break;
+    case ReadResult::Pending:
+        if (!connection.backlogged)
+        {
+            connection.backlogged = true;
+            m_backlog.push_back(connection.fd);
+        }
+        if (!readingPaused())
+            scheduleBacklog();
+        break;
+    case ReadResult::Closed:
+        closeConnection(connection);
+        break;
+    }
+}
+
+EpollReceiver::ReadResult EpollReceiver::readConnection(Connection &connection, EventMessageBatch &batch)
+{
+    qsizetype budget = s_readBudgetBytes;
+    while (budget > 0 && !readingPaused())
+    {
+        // Small reads land directly in the framer, bursts spill into the pooled chunk
+        iovec iov[2];
+        iov[0].iov_base = connection.framer.prepareWrite(s_minFramerSpace);
+        iov[0].iov_len = static_cast<size_t>(connection.framer.writableBytes());
+        iov[1].iov_base = m_chunk.get();
+        iov[1].iov_len = static_cast<size_t>(s_chunkSize);
+
+        const ssize_t received = ::readv(connection.fd, iov, 2);
+        if (received < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return ReadResult::Drained;
+            qWarning() << "readv failed:" << qt_error_string(errno);
+            return ReadResult::Closed;
+        }
+        if (received == 0)
+            return ReadResult::Closed;
+
+        const qsizetype direct = std::min<qsizetype>(received, static_cast<qsizetype>(iov[0].iov_len));
+        connection.framer.commitWrite(direct);
+        if (received > direct)
+        {
+            const qsizetype rest = received - direct;
+            std::memcpy(connection.framer.prepareWrite(rest), m_chunk.get(), static_cast<size_t>(rest));
+            connection.framer.commitWrite(rest);
+        }
+
+        decodeLines(connection, batch);
+        if (connection.closing)
+            return ReadResult::Closed;
+        budget -= received;
+    }
+    return ReadResult::Pending;
+}
+
+void EpollReceiver::decodeLines(Connection &connection, EventMessageBatch &batch)
+{
+    QByteArrayView rawLine;
+    while (connection.framer.nextLine(rawLine))
+    {
+        const QByteArrayView line = rawLine.trimmed();
+        if (line.isEmpty())
+            continue;
+
+        EventMessage msg;
+        const LineStatus status = m_decoder.decodeMessage(line, msg);
+        if (status == LineStatus::Invalid)
+        {
+            qWarning() << "Invalid JSON:" << m_decoder.errorString() << "Data:" << line;
+            continue;
+        }
+        if (status == LineStatus::Corrupted)
+        {
+            batch.append(std::move(msg));
+            continue;
+        }
+
+        m_clients[msg.clientId] = connection.fd;
+
+        // if module 3 has a critical message stop the entire logger
+        if (msg.severity == Severity::Critical)
+        {
+            if (msg.clientId == 3)
+                QMetaObject::invokeMethod(this, &EpollReceiver::closeImpl, Qt::QueuedConnection);
+            // for the other 2 modules just stop the respective module
+            else
+                closeClient(msg.clientId);
+        }
+        batch.append(std::move(msg));
+
+        if (connection.closing)
+            break;
+    }
+}
+
+void EpollReceiver::closeClient(const uint32_t clientId)
+{
+    const auto client = m_clients.constFind(clientId);
+    if (client == m_clients.constEnd())
+        return;
+
+    const auto it = m_connections.find(client.value());
+    if (it != m_connections.end())
+        closeConnection(*it->second);
+}
+
+void EpollReceiver::closeConnection(Connection &connection)
+{
+    if (connection.closing)
+        return;
+
+    // The descriptor stays open until reapClosed() so its number cannot be reused
+    // while events or backlog entries for it may still be around
+    connection.closing = true;
+    ::epoll_ctl(m_epollFd, EPOLL_CTL_DEL, connection.fd, nullptr);
+    ::shutdown(connection.fd, SHUT_RDWR);
+    for (auto it = m_clients.begin(); it != m_clients.end();)
+    {
+        if (it.value() == connection.fd)
+            it = m_clients.erase(it);
+        else
+            ++it;
+    }
+    m_closed.push_back(connection.fd);
+}
+
+void EpollReceiver::reapClosed()
+{
+    for (const int fd : m_closed)
+    {
+        m_connections.erase(fd);
+        ::close(fd);
+    }
+    m_closed.clear();
+}
+
+void EpollReceiver::scheduleBacklog()
+{
+    if (m_backlogScheduled)
+        return;
+    m_backlogScheduled = true;
+    QTimer::singleShot(0, this, &EpollReceiver::processBacklog);
+}
+
+void EpollReceiver::deliver(EventMessageBatch &batch)
+{
+    // Everything parsed in this pass crosses the thread boundary in one go
+    if (!batch.isEmpty() && !m_publisher.publish(batch))
+        emit messagesReceived(batch);
+}
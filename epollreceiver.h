@@ -0,0 +1,91 @@
+#ifndef EPOLLRECEIVER_H
+#define EPOLLRECEIVER_H
+
+#include <QHash>
+#include <QSocketNotifier>
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "receiverbackend.h"
+#include "eventdecoder.h"
+#include "lineframer.h"
+#include "ringpublisher.h"
+
+// Linux only ingest backend for large connection counts. One edge-triggered
+// epoll set holds the listening socket and every connection; the receiver
+// thread's event loop only watches the epoll descriptor itself. Connections are
+// accepted with accept4() straight into non-blocking mode and read with readv()
+// into the framer's spare space plus one pooled overflow chunk, so idle
+// connections keep small buffers and no QTcpSocket/QIODevice is involved.
+class EpollReceiver : public ReceiverBackend
+{
+    Q_OBJECT
+public:
+    explicit EpollReceiver(QObject *parent = nullptr);
+    ~EpollReceiver();
+
+    EpollReceiver(const EpollReceiver&) = delete;
+    EpollReceiver& operator=(const EpollReceiver&) = delete;
+    EpollReceiver(EpollReceiver&&) = delete;
+    EpollReceiver& operator=(EpollReceiver&&) = delete;
+
+    bool listen(const QHostAddress &address, const quint16 port) override;
+    void close() override;
+    bool isListening() const override;
+    void stopClient(uint32_t clientId) override;
+    void setMessageRing(std::shared_ptr<EventMessageRing> ring, std::function<void()> notifier) override;
+
+    // The whole epoll set is serviced by one event loop, the count is ignored
+    void setWorkerCount(const int workerCount) override;
+
+    void setFlowControl(std::shared_ptr<FlowControl> flowControl) override;
+    void resumeReading() override;
+
+private:
+    struct Connection {
+        int fd {-1};
+        LineFramer framer {512};
+        bool closing {false};
+        bool backlogged {false};   // unread data left after the per pass budget or while paused
+    };
+
+    enum class ReadResult {
+        Drained,        // EAGAIN, wait for the next edge
+        Pending,        // budget spent or reading paused, continue on a later pass
+        Closed          // EOF, error or closed while decoding
+    };
+
+    bool listenImpl(const QHostAddress &address, const quint16 port);
+    bool readingPaused() const;
+    void closeImpl();
+    void processEvents();
+    void processBacklog();
+    void acceptConnections();
+    void serviceConnection(Connection &connection, EventMessageBatch &batch);
+    ReadResult readConnection(Connection &connection, EventMessageBatch &batch);
+    void decodeLines(Connection &connection, EventMessageBatch &batch);
+    void closeClient(const uint32_t clientId);
+    void closeConnection(Connection &connection);
+    void reapClosed();
+    void scheduleBacklog();
+    void deliver(EventMessageBatch &batch);
+
+private:
+    int m_epollFd {-1};
+    int m_listenFd {-1};
+    std::unique_ptr<QSocketNotifier> m_notifier;
+    std::unordered_map<int, std::unique_ptr<Connection>> m_connections;
+    QHash<uint32_t, int> m_clients;
+    std::vector<int> m_backlog;
+    std::vector<int> m_closed;
+    bool m_backlogScheduled {false};
+    bool m_dispatching {false};
+    std::unique_ptr<char[]> m_chunk;
+    EventMessageDecoder m_decoder;
+    RingPublisher m_publisher;
+    std::shared_ptr<FlowControl> m_flowControl;
+    std::atomic<bool> m_listening {false};
+};
+
+#endif // EPOLLRECEIVER_H
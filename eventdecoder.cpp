@@ -0,0 +1,490 @@
+#include "eventdecoder.h"
+#include "moduleregistry.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define EVENTDECODER_HAS_SSE2
+#endif
+
+namespace {
+
+enum Field : int {
+    Client = 0,
+    Type = 1,
+    Message = 2,
+    Timestamp = 3
+};
+
+constexpr qint64 s_maxClientDigits {15};
+constexpr double s_maxEpochTimestamp {1e18};
+
+inline const char *skipWhitespace(const char *p, const char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'))
+        ++p;
+    return p;
+}
+
+// First '"', '\\' or control character in [p, end), or end
+inline const char *findStringSpecial(const char *p, const char *end)
+{
+#ifdef EVENTDECODER_HAS_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i controlMax = _mm_set1_epi8(0x1F);
+    while (end - p >= 16)
+    {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        const __m128i isQuote = _mm_cmpeq_epi8(chunk, quote);
+        const __m128i isBackslash = _mm_cmpeq_epi8(chunk, backslash);
+        // unsigned chunk <= 0x1F  <=>  min(chunk, 0x1F) == chunk
+        const __m128i isControl = _mm_cmpeq_epi8(_mm_min_epu8(chunk, controlMax), chunk);
+        const int mask = _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(isQuote, isBackslash), isControl));
+        if (mask != 0)
+            return p + std::countr_zero(static_cast<unsigned>(mask));
+        p += 16;
+    }
+#endif
+    while (p < end)
+    {
+        const unsigned char c = static_cast<unsigned char>(*p);
+        if (c == '"' || c == '\\' || c < 0x20)
+            return p;
+        ++p;
+    }
+    return end;
+}
+
+// Strict UTF-8 as QJsonDocument reads it: no overlong forms, no surrogates,
+// nothing above U+10FFFF. ASCII runs are skipped 16 bytes at a time.
+bool isValidUtf8(const char *p, const char *end)
+{
+    while (p < end)
+    {
+#ifdef EVENTDECODER_HAS_SSE2
+        while (end - p >= 16)
+        {
+            const int mask = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+            if (mask != 0)
+            {
+                p += std::countr_zero(static_cast<unsigned>(mask));
+                break;
+            }
+            p += 16;
+        }
+        if (p == end)
+            return true;
+#endif
+        const unsigned char lead = static_cast<unsigned char>(*p);
+        if (lead < 0x80)
+        {
+            ++p;
+            continue;
+        }
+
+        int length {0};
+        unsigned char low {0x80};
+        unsigned char high {0xBF};
+        if (lead >= 0xC2 && lead <= 0xDF) {
+            length = 2;
+        } else if (lead >= 0xE0 && lead <= 0xEF) {
+            length = 3;
+            if (lead == 0xE0) low = 0xA0;       // overlong
+            if (lead == 0xED) high = 0x9F;      // surrogates
+        } else if (lead >= 0xF0 && lead <= 0xF4) {
+            length = 4;
+            if (lead == 0xF0) low = 0x90;       // overlong
+            if (lead == 0xF4) high = 0x8F;      // above U+10FFFF
+        } else {
+            return false;
+        }
+        if (end - p < length)
+            return false;
+
+        const unsigned char second = static_cast<unsigned char>(p[1]);
+        if (second < low || second > high)
+            return false;
+        for (int i = 2; i < length; ++i)
+        {
+            if ((static_cast<unsigned char>(p[i]) & 0xC0) != 0x80)
+                return false;
+        }
+        p += length;
+    }
+    return true;
+}
+
+inline int fieldIndex(const QByteArrayView key)
+{
+    switch (key.size()) {
+    case 4:
+        return std::memcmp(key.data(), "type", 4) == 0 ? Type : -1;
+    case 6:
+        return std::memcmp(key.data(), "client", 6) == 0 ? Client : -1;
+    case 7:
+        return std::memcmp(key.data(), "message", 7) == 0 ? Message : -1;
+    case 9:
+        return std::memcmp(key.data(), "timestamp", 9) == 0 ? Timestamp : -1;
+    default:
+        return -1;
+    }
+}
+
+inline bool parseHex4(const char *p, const char *end, char32_t &value)
+{
+    if (end - p < 4)
+        return false;
+
+    value = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        const char c = p[i];
+        value <<= 4;
+        if (c >= '0' && c <= '9')
+            value |= static_cast<char32_t>(c - '0');
+        else if (c >= 'a' && c <= 'f')
+            value |= static_cast<char32_t>(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F')
+            value |= static_cast<char32_t>(c - 'A' + 10);
+        else
+            return false;
+    }
+    return true;
+}
+
+inline void appendUtf8(std::string &out, const char32_t cp)
+{
+    if (cp < 0x80) {
+        out.push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+}
+
+// p points at the 'u' of a \uXXXX escape. On success p is left on the last
+// consumed character.
+inline bool decodeUnicodeEscape(const char *&p, const char *end, std::string &out)
+{
+    char32_t cp {0};
+    if (!parseHex4(p + 1, end, cp))
+        return false;
+    p += 4;
+
+    if (cp >= 0xDC00 && cp <= 0xDFFF)
+        return false;   // lone low surrogate
+
+    if (cp >= 0xD800 && cp <= 0xDBFF)
+    {
+        char32_t low {0};
+        if (end - p < 7 || p[1] != '\\' || p[2] != 'u' || !parseHex4(p + 3, end, low))
+            return false;
+        if (low < 0xDC00 || low > 0xDFFF)
+            return false;
+        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+        p += 6;
+    }
+
+    appendUtf8(out, cp);
+    return true;
+}
+
+// p points behind the opening quote. Returns the position behind the closing
+// quote, or nullptr if the string is not valid JSON.
+const char *parseString(const char *p, const char *end, std::string &scratch, QByteArrayView &out)
+{
+    const char *start = p;
+    p = findStringSpecial(p, end);
+    if (p == end)
+        return nullptr;
+
+    if (*p == '"')
+    {
+        // Common case: nothing to unescape, hand out a view into the line
+        out = QByteArrayView(start, p - start);
+        return p + 1;
+    }
+
+    scratch.assign(start, p);
+    while (true)
+    {
+        if (*p == '"')
+        {
+            out = QByteArrayView(scratch.data(), static_cast<qsizetype>(scratch.size()));
+            return p + 1;
+        }
+        if (*p != '\\' || ++p == end)
+            return nullptr;
+
+        switch (*p) {
+        case '"':  scratch.push_back('"');  break;
+        case '\\': scratch.push_back('\\'); break;
+        case '/':  scratch.push_back('/');  break;
+        case 'b':  scratch.push_back('\b'); break;
+        case 'f':  scratch.push_back('\f'); break;
+        case 'n':  scratch.push_back('\n'); break;
+        case 'r':  scratch.push_back('\r'); break;
+        case 't':  scratch.push_back('\t'); break;
+        case 'u':
+            if (!decodeUnicodeEscape(p, end, scratch))
+                return nullptr;
+            break;
+        default:
+            return nullptr;
+        }
+
+        ++p;
+        const char *next = findStringSpecial(p, end);
+        if (next == end)
+            return nullptr;
+        scratch.append(p, next);
+        p = next;
+    }
+}
+
+// Plain JSON integer. Fractions, exponents and anything the generic parser
+// would treat differently are left to the fallback.
+const char *parseInteger(const char *p, const char *end, qint64 &value)
+{
+    bool negative {false};
+    if (*p == '-')
+    {
+        negative = true;
+        if (++p == end)
+            return nullptr;
+    }
+
+    const char *digits = p;
+    qint64 result {0};
+    while (p < end && *p >= '0' && *p <= '9')
+    {
+        result = result * 10 + (*p - '0');
+        ++p;
+    }
+
+    const qint64 count = p - digits;
+    if (count == 0 || count > s_maxClientDigits)
+        return nullptr;
+    if (count > 1 && *digits == '0')
+        return nullptr;
+    if (p < end && (*p == '.' || *p == 'e' || *p == 'E'))
+        return nullptr;
+
+    value = negative ? -result : result;
+    return p;
+}
+
+// Unsigned JSON integer handed out as its digits, used for epoch timestamps.
+// Anything else is left to the fallback.
+const char *parseDigits(const char *p, const char *end, QByteArrayView &out)
+{
+    const char *digits = p;
+    while (p < end && *p >= '0' && *p <= '9')
+        ++p;
+
+    const qint64 count = p - digits;
+    if (count == 0 || (count > 1 && *digits == '0'))
+        return nullptr;
+    if (p < end && (*p == '.' || *p == 'e' || *p == 'E'))
+        return nullptr;
+
+    out = QByteArrayView(digits, count);
+    return p;
+}
+
+} // namespace
+
+bool EventMessageDecoder::decode(QByteArrayView line, EventFields &fields)
+{
+    if (decodeFast(line, fields))
+        return true;
+
+    return decodeFallback(line, fields);
+}
+
+LineStatus EventMessageDecoder::decodeMessage(QByteArrayView line, EventMessage &msg)
+{
+    EventFields fields;
+    if (!decode(line, fields))
+        return LineStatus::Invalid;
+
+    const uint32_t parsedClientId = static_cast<uint32_t>(fields.client);
+    Severity severity {Severity::Info};
+    qint64 timestamp {0};
+
+    msg.severity = Severity::Warning;
+    if (!ModuleRegistry::isValidModuleId(parsedClientId))
+    {
+        msg.clientId = 0;
+        msg.text = MessageText::fromUtf8("Invalid module number on the received message!!");
+        msg.timestamp = currentTimestamp();
+        return LineStatus::Corrupted;
+    }
+    else if (!severityFromName(fields.type, severity))
+    {
+        msg.clientId = parsedClientId;
+        msg.text = MessageText::fromUtf8("Corrupted message type received from client!Invalid message type!");
+        msg.timestamp = currentTimestamp();
+        return LineStatus::Corrupted;
+    }
+    else if (!m_timestampParser.parse(fields.timestamp, timestamp))
+    {
+        msg.clientId = parsedClientId;
+        msg.text = MessageText::fromUtf8("Corrupted message type received from client!Invalid timestamp!");
+        msg.timestamp = currentTimestamp();
+        return LineStatus::Corrupted;
+    }
+
+    msg.clientId = parsedClientId;
+    msg.severity = severity;
+    msg.text = MessageText::fromUtf8(fields.message);
+    msg.timestamp = timestamp;
+    return LineStatus::Valid;
+}
+
+bool EventMessageDecoder::decodeFast(QByteArrayView line, EventFields &fields)
+{
+    const char *p = line.data();
+    const char *const end = p + line.size();
+
+    fields = EventFields{};
+
+    // the strings are handed out as they are, so the line has to be valid UTF-8;
+    // anything else goes to QJsonDocument, which rejects it
+    if (!isValidUtf8(p, end))
+        return false;
+
+    p = skipWhitespace(p, end);
+    if (p == end || *p != '{')
+        return false;
+
+    p = skipWhitespace(p + 1, end);
+    if (p < end && *p == '}')
+        return skipWhitespace(p + 1, end) == end;
+
+    unsigned seen {0};
+    while (true)
+    {
+        if (p == end || *p != '"')
+            return false;
+
+        // The expected keys are plain ASCII, an escaped key goes to the fallback
+        const char *keyStart = p + 1;
+        const char *keyEnd = findStringSpecial(keyStart, end);
+        if (keyEnd == end || *keyEnd != '"')
+            return false;
+
+        const int field = fieldIndex(QByteArrayView(keyStart, keyEnd - keyStart));
+        if (field < 0 || (seen & (1U << field)))
+            return false;
+        seen |= 1U << field;
+
+        p = skipWhitespace(keyEnd + 1, end);
+        if (p == end || *p != ':')
+            return false;
+
+        p = skipWhitespace(p + 1, end);
+        if (p == end)
+            return false;
+
+        switch (field) {
+        case Client:
+            p = parseInteger(p, end, fields.client);
+            // same result as QJsonValue::toInt() for values outside int
+            if (fields.client < std::numeric_limits<int>::min() || fields.client > std::numeric_limits<int>::max())
+                fields.client = 0;
+            break;
+        case Type:
+            p = (*p == '"') ? parseString(p + 1, end, m_scratch[0], fields.type) : nullptr;
+            break;
+        case Message:
+            p = (*p == '"') ? parseString(p + 1, end, m_scratch[1], fields.message) : nullptr;
+            break;
+        case Timestamp:
+            p = (*p == '"') ? parseString(p + 1, end, m_scratch[2], fields.timestamp) : parseDigits(p, end, fields.timestamp);
+            break;
+        }
+        if (!p)
+            return false;
+
+        p = skipWhitespace(p, end);
+        if (p == end)
+            return false;
+
+        if (*p == ',')
+        {
+            p = skipWhitespace(p + 1, end);
+            continue;
+        }
+        if (*p != '}')
+            return false;
+
+        return skipWhitespace(p + 1, end) == end;
+    }
+}
+
+bool EventMessageDecoder::decodeFallback(QByteArrayView line, EventFields &fields)
+{
+    ++m_fallbackCount;
+    fields = EventFields{};
+
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(line.toByteArray(), &parseError);
+    if (parseError.error != QJsonParseError::NoError)
+    {
+        m_error = parseError.errorString();
+        return false;
+    }
+    if (!doc.isObject())
+    {
+        m_error = QStringLiteral("message is not a JSON object");
+        return false;
+    }
+
+    const QJsonObject obj = doc.object();
+    m_scratch[0] = obj.value("type").toString().toStdString();
+    m_scratch[1] = obj.value("message").toString().toStdString();
+    const QJsonValue timestamp = obj.value("timestamp");
+    if (timestamp.isDouble())
+    {
+        // Integral epoch values only, anything else ends up as an invalid timestamp
+        const double value = timestamp.toDouble();
+        const bool integral = value >= 0 && value < s_maxEpochTimestamp && value == std::floor(value);
+        m_scratch[2] = integral ? QByteArray::number(static_cast<qint64>(value)).toStdString() : std::string();
+    }
+    else
+    {
+        m_scratch[2] = timestamp.toString().toStdString();
+    }
+
+    fields.client = obj.value("client").toInt();
+    fields.type = QByteArrayView(m_scratch[0].data(), static_cast<qsizetype>(m_scratch[0].size()));
+    fields.message = QByteArrayView(m_scratch[1].data(), static_cast<qsizetype>(m_scratch[1].size()));
+    fields.timestamp = QByteArrayView(m_scratch[2].data(), static_cast<qsizetype>(m_scratch[2].size()));
+    return true;
+}
+
+QString EventMessageDecoder::errorString() const
+{
+    return m_error;
+}
+
+quint64 EventMessageDecoder::fallbackCount() const
+{
+    return m_fallbackCount;
+}
@@ -0,0 +1,62 @@
+#ifndef EVENTDECODER_H
+#define EVENTDECODER_H
+
+#include <QByteArrayView>
+#include <QString>
+#include <string>
+#include "eventmessage.h"
+#include "timestampparser.h"
+
+// Raw fields of one event line. The views point either into the decoded line
+// or into scratch storage of the decoder and stay valid until the next decode().
+struct EventFields {
+    qint64 client {0};
+    QByteArrayView type;
+    QByteArrayView message;   // UTF-8, escapes already resolved
+    QByteArrayView timestamp; // string contents, or the digits of a numeric epoch value
+};
+
+// Outcome of turning one line into an EventMessage
+enum class LineStatus {
+    Invalid,    // not a JSON object, nothing to report
+    Corrupted,  // parsed, but failed validation: the message is a WARNING describing why
+    Valid
+};
+
+// Decoder specialised for the four field message
+// {"client": N, "type": "...", "message": "...", "timestamp": "..."}; the
+// timestamp may also be an integer epoch value, see TimestampParser.
+// The line is checked to be valid UTF-8 (an SSE2 scan skips the ASCII runs),
+// then the fields are pulled out in a single pass without building a DOM and
+// without allocating; strings without escapes are returned as views into the
+// line itself. Lines with invalid UTF-8 or without the expected shape (unknown
+// or duplicate keys, unexpected value types, ...) are handed to QJsonDocument
+// instead, so the accepted input is exactly what the generic parser accepts.
+class EventMessageDecoder
+{
+public:
+    EventMessageDecoder() = default;
+
+    bool decode(QByteArrayView line, EventFields &fields);
+
+    // decode() plus the validation of module number, type and timestamp
+    LineStatus decodeMessage(QByteArrayView line, EventMessage &msg);
+
+    // Why the last decode() failed
+    QString errorString() const;
+
+    // Number of lines that needed the QJsonDocument path
+    quint64 fallbackCount() const;
+
+private:
+    bool decodeFast(QByteArrayView line, EventFields &fields);
+    bool decodeFallback(QByteArrayView line, EventFields &fields);
+
+private:
+    std::string m_scratch[3];
+    QString m_error;
+    quint64 m_fallbackCount {0};
+    TimestampParser m_timestampParser;
+};
+
+#endif // EVENTDECODER_H
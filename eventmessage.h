@@ -1,14 +1,76 @@
 #ifndef EVENTMESSAGE_H
 #define EVENTMESSAGE_H
 
-#include <QString>
+#include <QByteArrayView>
 #include <QDateTime>
+#include <QLatin1String>
+#include <QList>
+#include <chrono>
+#include "messagetext.h"
 
+// Message type, ordered by how much the Logger cares about it: DATA is dropped
+// first, CRITICAL last
+enum class Severity : uint8_t {
+    Data,
+    Info,
+    Warning,
+    Error,
+    Critical
+};
+
+constexpr int SeverityCount {5};
+
+inline QLatin1String severityName(const Severity severity)
+{
+    switch (severity)
+    {
+    case Severity::Data:     return QLatin1String("DATA");
+    case Severity::Info:     return QLatin1String("INFO");
+    case Severity::Warning:  return QLatin1String("WARNING");
+    case Severity::Error:    return QLatin1String("ERROR");
+    case Severity::Critical: return QLatin1String("CRITICAL");
+    }
+    return QLatin1String("UNKNOWN");
+}
+
+// Severity for the type field of the wire format, false for unknown types
+inline bool severityFromName(const QByteArrayView name, Severity &severity)
+{
+    for (int i = 0; i < SeverityCount; ++i)
+    {
+        const QLatin1String candidate = severityName(static_cast<Severity>(i));
+        if (name == QByteArrayView(candidate.data(), candidate.size()))
+        {
+            severity = static_cast<Severity>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// One cache line per message: no heap allocation unless the text outgrows MessageText's inline buffer
 struct EventMessage {
-    uint32_t clientId;
-    QString type; // INFO, WARNING, ERROR
-    QString text;
-    QDateTime timestamp;
+    qint64 timestamp {0};  // microseconds since the Unix epoch
+    uint32_t clientId {0};
+    Severity severity {Severity::Info};
+    MessageText text;      // UTF-8
 };
 
+static_assert(sizeof(EventMessage) == 64, "EventMessage is meant to fill one cache line");
+
+// Messages parsed from one read, handed across threads as a single implicitly shared list
+using EventMessageBatch = QList<EventMessage>;
+
+// Current time in the unit of EventMessage::timestamp
+inline qint64 currentTimestamp()
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+inline QDateTime timestampToDateTime(const qint64 timestamp)
+{
+    return QDateTime::fromMSecsSinceEpoch(timestamp / 1000);
+}
+
 #endif // EVENTMESSAGE_H
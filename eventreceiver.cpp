@@ -1,35 +1,15 @@
 #include "eventreceiver.h"
-#include <QTcpSocket>
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QRegularExpression>
+#include "threadutils.h"
 #include <QDebug>
-#include <QTimer>
-#include <QDateTime>
-#include <QThread>
-#include <concepts>
+#include <algorithm>
 
-template<class F>
-concept QtZeroArgInvocable =
-    std::invocable<F&> &&
-    std::same_as<void, std::invoke_result_t<F&>> &&
-    std::is_move_constructible_v<std::decay_t<F>>;
-
-template<class Obj, class F>
-    requires std::derived_from<Obj, QObject> && QtZeroArgInvocable<F>
-void invokeOnObjectThread(Obj * obj, F&& func)
+void ShardingTcpServer::incomingConnection(qintptr socketDescriptor)
 {
-    if (QThread::currentThread() == obj->thread()) {
-        func();
-    } else {
-        QMetaObject::invokeMethod(obj,[fn = std::forward<F>(func)]() mutable {
-            fn();
-        }, Qt::QueuedConnection);
-    }
+    emit descriptorAccepted(socketDescriptor);
 }
 
 EventReceiver::EventReceiver(QObject *parent)
-    : QObject(parent)
+    : ReceiverBackend(parent)
 {
 }
 
@@ -46,18 +26,19 @@ EventReceiver::~EventReceiver()
 
 bool EventReceiver::listen(const QHostAddress &address, const uint16_t port)
 {
-    if (!m_server)
-    {
-        bool success {false};
-        QMetaObject::invokeMethod(this, [this, address, port, &success] {
-            m_server = std::make_unique<QTcpServer>(this); // Now constructed in the correct thread
-            connect(m_server.get(), &QTcpServer::newConnection, this, &EventReceiver::handleNewConnection);
-            success = m_server->listen(address, port);
-        }, Qt::BlockingQueuedConnection);
-        return success;
-    }
-
-    return m_server->listen(address, port);
+    bool success {false};
+    QMetaObject::invokeMethod(this, [this, address, port, &success] {
+        if (!m_server)
+        {
+            m_server = std::make_unique<ShardingTcpServer>(this); // Now constructed in the correct thread
+            connect(m_server.get(), &ShardingTcpServer::descriptorAccepted, this, &EventReceiver::dispatchConnection);
+        }
+        startWorkers();
+        success = m_server->listen(address, port);
+        if (!success)
+            stopWorkers();
+    }, Qt::BlockingQueuedConnection);
+    return success;
 }
 
 void EventReceiver::close()
@@ -70,16 +51,6 @@ void EventReceiver::close()
 
 void EventReceiver::closeImpl()
 {
-    if (!m_clients.empty())
-    {
-        const QList<uint32_t> ids = m_clients.keys();
-        for (uint32_t id : ids)
-            closeSocketOnce(id);
-
-        m_clients.clear();
-        m_pendingBuffers.clear();
-    }
-
     if (m_server)
     {
         if (m_server->isListening())
@@ -88,82 +59,68 @@ void EventReceiver::closeImpl()
             m_server.reset();
         }
     }
+
+    stopWorkers();
 }
 
-void EventReceiver::closeSocketOnce(const uint32_t clientId)
+void EventReceiver::startWorkers()
 {
-    try {
-        auto it = m_clients.find(clientId);
-        if (it == m_clients.end())
-            return;
-
-        QTcpSocket* socket = it.value();
-        if (!socket)
-            return;
-
-        // One-shot guard
-        if (m_closing.contains(socket))
-            return;
-
-        m_closing.insert(socket);
-
-        socket->disconnect(this);
-
-        socket->disconnectFromHost();
-        if (socket->state() != QAbstractSocket::UnconnectedState)
-            socket->close();
-
-        m_pendingBuffers.remove(socket);
-        const int key = m_clients.key(socket, -1);
-        if (key != -1)
-            m_clients.remove(key);
+    if (!m_workers.empty())
+        return;
 
-        // Defer deletion on owning thread (idempotent)
-        socket->deleteLater();
-    }
-    catch (const std::exception &e) {
-        qDebug() << "Exception while closing the sockets message:" << e.what();
-    } catch (...) {
-        qDebug() << "Unknown error while closing the sockets.";
+    m_workers.reserve(m_workerCount);
+    for (int i = 0; i < m_workerCount; ++i)
+    {
+        WorkerSlot slot;
+        slot.thread = std::make_unique<QThread>();
+        slot.thread->setObjectName(QString("ReceiverWorker %1").arg(i));
+        slot.worker = new ReceiverWorker();
+        slot.worker->setMessageRing(m_ring, m_ringNotifier);
+        slot.worker->setFlowControl(m_flowControl);
+        slot.worker->moveToThread(slot.thread.get());
+
+        // Forwarded directly, the consumer's own connection does the thread hop
+        connect(slot.worker, &ReceiverWorker::messagesReceived, this, &EventReceiver::messagesReceived, Qt::DirectConnection);
+        connect(slot.worker, &ReceiverWorker::shutdownRequested, this, &EventReceiver::close, Qt::QueuedConnection);
+        connect(slot.thread.get(), &QThread::finished, slot.worker, &QObject::deleteLater);
+
+        slot.thread->start();
+        m_workers.push_back(std::move(slot));
     }
+    m_nextWorker = 0;
 }
 
-void EventReceiver::handleNewConnection()
-{    
-    while (m_server->hasPendingConnections())
+void EventReceiver::stopWorkers()
+{
+    for (WorkerSlot &slot : m_workers)
     {
-        QTcpSocket *clientSocket = m_server->nextPendingConnection();
-        if (!clientSocket) continue;
-
-        connect(clientSocket, &QTcpSocket::readyRead, this, [this]() {
-            QPointer<QTcpSocket> sock = qobject_cast<QTcpSocket*>(sender());
-            onReadyRead(sock);
-        });
-
-        connect(clientSocket, &QTcpSocket::disconnected, this, [this]() {
-            QPointer<QTcpSocket> sock = qobject_cast<QTcpSocket*>(sender());
-            if (!sock)
-                return;
-
-            if (m_closing.contains(sock.data()))
-                return;
+        QMetaObject::invokeMethod(slot.worker, &ReceiverWorker::closeAll, Qt::BlockingQueuedConnection);
+        slot.thread->quit();
+        slot.thread->wait();
+    }
+    m_workers.clear();
+}
 
-            if (!m_clients.values().contains(sock.data()))
-                return;
+void EventReceiver::dispatchConnection(qintptr socketDescriptor)
+{
+    if (m_workers.empty())
+        return;
 
-            const int clientKey = m_clients.key(sock, -1);
-            // for (auto it = m_clients.cbegin(); it != m_clients.cend(); ++it)
-            //     qDebug() << it.key() << reinterpret_cast<void*>(it.value());
-            if (clientKey != -1)
-            {
-                m_clients.remove(clientKey);
-            }
-            // for (auto it = m_clients.cbegin(); it != m_clients.cend(); ++it)
-            //     qDebug() << it.key() << reinterpret_cast<void*>(it.value());
-            m_pendingBuffers.remove(sock.data());
-            sock->deleteLater();
-        });
+    // Least connections, scanning from the round robin cursor so ties rotate
+    size_t chosen = m_nextWorker % m_workers.size();
+    for (size_t i = 0; i < m_workers.size(); ++i)
+    {
+        const size_t candidate = (m_nextWorker + i) % m_workers.size();
+        if (m_workers[candidate].worker->connectionCount() < m_workers[chosen].worker->connectionCount())
+            chosen = candidate;
     }
+    m_nextWorker = chosen + 1;
+
+    ReceiverWorker *worker = m_workers[chosen].worker;
+    worker->reserveConnection();
+    QMetaObject::invokeMethod(worker, [worker, socketDescriptor] {
+        worker->adoptSocket(socketDescriptor);
+    }, Qt::QueuedConnection);
 }
 
 bool EventReceiver::isListening() const
@@ -171,121 +128,40 @@ bool EventReceiver::isListening() const
     return m_server && m_server->isListening();
 }
 
-void EventReceiver::onReadyRead(QPointer<QTcpSocket> socket)
+void EventReceiver::stopClient(uint32_t clientId)
 {
-    if (!socket) {
-        qDebug() << "onReadyRead called but sender() was null!";
-        return;
-    }
-
-    try
-    {
-        QByteArray data = socket->readAll();
-        if (data.isEmpty())
-            return;
-
-        if (!m_pendingBuffers.contains(socket))
-        {
-            m_pendingBuffers[socket] = QByteArray();
-        }
-        m_pendingBuffers[socket].append(data.data());
-        while (true)
-        {
-            int newlineIndex = m_pendingBuffers[socket].indexOf('\n');
-            if (newlineIndex == -1)
-                break;
-
-            QByteArray line = m_pendingBuffers[socket].left(newlineIndex).trimmed();
-            m_pendingBuffers[socket].remove(0, newlineIndex + 1);
-
-            if (line.isEmpty())
-                continue;
-
-            QJsonParseError parseError;
-            QJsonDocument doc = QJsonDocument::fromJson(line, &parseError);
-            if (parseError.error != QJsonParseError::NoError || !doc.isObject())
-            {
-                qWarning() << "Invalid JSON:" << parseError.errorString() << "Data:" << line;
-                continue;
-            }
-
-            QJsonObject obj = doc.object();
-            const uint32_t parsedClientId = static_cast<uint32_t>(obj["client"].toInt());
-            const QString type = obj["type"].toString();
-            const QString message = obj["message"].toString();
-            const QString timestampStr = obj["timestamp"].toString();
-            const QDateTime timestamp = QDateTime::fromString(timestampStr, "yyyy-MM-dd HH:mm:ss");
-            bool isMsgCorrupted {false};
-
-            EventMessage msg;
-            msg.type = "WARNING";
-            if (parsedClientId < 1 || parsedClientId > 3)
-            {
-                msg.clientId = 0;
-                msg.text = QString("Invalid module number on the received message!!");
-                msg.timestamp = QDateTime::currentDateTime();
-                isMsgCorrupted = true;
-            }
-            else if (!QSet<QString>{"INFO", "WARNING", "ERROR", "CRITICAL", "DATA"}.contains(type))
-            {
-                msg.clientId = parsedClientId;
-                msg.text = QString("Corrupted message type received from client!Invalid message type!");
-                msg.timestamp = QDateTime::currentDateTime();
-                isMsgCorrupted = true;
-            }
-            else if (!timestamp.isValid())
-            {
-                msg.clientId = parsedClientId;
-                msg.text = QString("Corrupted message type received from client!Invalid timestamp!");
-                msg.timestamp = QDateTime::currentDateTime();
-                isMsgCorrupted = true;
-            }
-
-            if (isMsgCorrupted)
-            {
-                emit messageReceived(msg);
-                return;
-            }
-
-            // Quality check of the message
+    qDebug() << "stopClient called for" << clientId << "in thread";
+    invokeOnObjectThread(this, [this, clientId] {
+        for (const WorkerSlot &slot : m_workers)
+            slot.worker->stopClient(clientId);
+    });
+}
 
-            msg.clientId = parsedClientId;
-            msg.type = type;
-            msg.text = message;
-            msg.timestamp = timestamp;
+void EventReceiver::setMessageRing(std::shared_ptr<EventMessageRing> ring, std::function<void()> notifier)
+{
+    m_ring = std::move(ring);
+    m_ringNotifier = std::move(notifier);
+}
 
-            m_clients[msg.clientId] = socket.data();
+void EventReceiver::setWorkerCount(const int workerCount)
+{
+    m_workerCount = std::max(1, workerCount);
+}
 
-            // if module 3 has a critical message stop the entire logger
-            if ((msg.type == "CRITICAL"))
-            {
-                if (msg.clientId == 3)
-                {
-                    QTimer::singleShot(0, this, [this]{
-                        close();
-                    });
-                }
-                // for the other 2 modules just stop the respective module
-                else
-                {
-                    stopClient(msg.clientId);
-                }
-            }
-            emit messageReceived(msg);
-        }
-    }
-    catch (const std::exception &e) {
-        qDebug() << "Exception while handling CRITICAL message:" << e.what();
-    } catch (...) {
-        qDebug() << "Unknown error while handling CRITICAL message.";
-    }
+int EventReceiver::workerCount() const
+{
+    return m_workerCount;
+}
 
+void EventReceiver::setFlowControl(std::shared_ptr<FlowControl> flowControl)
+{
+    m_flowControl = std::move(flowControl);
 }
 
-void EventReceiver::stopClient(uint32_t clientId)
+void EventReceiver::resumeReading()
 {
-    qDebug() << "stopClient called for" << clientId << "in thread";
-    invokeOnObjectThread(this, [this, clientId] {
-        closeSocketOnce(clientId);
+    invokeOnObjectThread(this, [this] {
+        for (const WorkerSlot &slot : m_workers)
+            QMetaObject::invokeMethod(slot.worker, &ReceiverWorker::resumeReading, Qt::QueuedConnection);
     });
 }
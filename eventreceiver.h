@@ -4,12 +4,33 @@
 #include <QTcpServer>
 #include <QTcpSocket>
 #include <QHostAddress>
-#include <QMap>
-#include <QPointer>
+#include <QThread>
+#include <functional>
+#include <memory>
+#include <vector>
 #include "eventmessage.h"
+#include "messagering.h"
+#include "receiverbackend.h"
+#include "receiverworker.h"
 
+// QTcpServer that passes accepted descriptors on instead of creating the
+// QTcpSocket on the acceptor thread, so the socket can live on a worker thread.
+class ShardingTcpServer : public QTcpServer
+{
+    Q_OBJECT
+public:
+    using QTcpServer::QTcpServer;
 
-class EventReceiver : public QObject
+signals:
+    void descriptorAccepted(qintptr socketDescriptor);
+
+protected:
+    void incomingConnection(qintptr socketDescriptor) override;
+};
+
+// Acceptor plus a pool of ReceiverWorker I/O threads. Every accepted connection
+// is handed to the worker with the fewest connections (round robin on ties).
+class EventReceiver : public ReceiverBackend
 {
     Q_OBJECT
 public:
@@ -21,27 +42,38 @@ public:
     EventReceiver(EventReceiver&&) = delete;
     EventReceiver& operator=(EventReceiver&&) = delete;
 
-    bool listen(const QHostAddress &address, const quint16 port);
-    void close();
-    bool isListening() const;
-    void stopClient(uint32_t clientId);
-
-signals:
-    void messageReceived(const EventMessage &msg);
+    bool listen(const QHostAddress &address, const quint16 port) override;
+    void close() override;
+    bool isListening() const override;
+    void stopClient(uint32_t clientId) override;
+    void setMessageRing(std::shared_ptr<EventMessageRing> ring, std::function<void()> notifier) override;
+    void setWorkerCount(const int workerCount) override;
+    int workerCount() const;
+    void setFlowControl(std::shared_ptr<FlowControl> flowControl) override;
+    void resumeReading() override;
 
 protected slots:
-    void handleNewConnection();
-    void onReadyRead(QPointer<QTcpSocket> socket);
+    void dispatchConnection(qintptr socketDescriptor);
 
 private:
     void closeImpl();
-    void closeSocketOnce(const uint32_t clientId);
+    void startWorkers();
+    void stopWorkers();
 
 private:
-    std::unique_ptr<QTcpServer> m_server;
-    QMap<uint32_t, QTcpSocket*> m_clients;
-    QMap<QTcpSocket*, QByteArray> m_pendingBuffers;
-    QSet<QTcpSocket*> m_closing;
+    struct WorkerSlot {
+        std::unique_ptr<QThread> thread;
+        ReceiverWorker *worker = nullptr;   // deleted via deleteLater when its thread finishes
+    };
+
+    std::unique_ptr<ShardingTcpServer> m_server;
+    std::vector<WorkerSlot> m_workers;
+    size_t m_nextWorker {0};
+    int m_workerCount {1};
+
+    std::shared_ptr<EventMessageRing> m_ring;
+    std::function<void()> m_ringNotifier;
+    std::shared_ptr<FlowControl> m_flowControl;
 };
 
 #endif // EVENTRECEIVER_H
@@ -0,0 +1,45 @@
+#ifndef FLOWCONTROL_H
+#define FLOWCONTROL_H
+
+#include <atomic>
+
+// Read gate between the Logger and the receiver threads. With flow control
+// enabled the Logger closes the gate when its queue reaches the high-water mark
+// and opens it again at the low-water mark; while it is closed the receivers
+// leave incoming data in the socket buffers so TCP pushes back on the senders.
+// The receivers only poll isPaused(), reopening is signalled separately
+// (ReceiverBackend::resumeReading()) so parked sockets get read again.
+class FlowControl
+{
+public:
+    FlowControl() = default;
+
+    FlowControl(const FlowControl&) = delete;
+    FlowControl& operator=(const FlowControl&) = delete;
+
+    void setEnabled(const bool enabled)
+    {
+        m_enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool isEnabled() const
+    {
+        return m_enabled.load(std::memory_order_relaxed);
+    }
+
+    void setPaused(const bool paused)
+    {
+        m_paused.store(paused, std::memory_order_release);
+    }
+
+    bool isPaused() const
+    {
+        return m_paused.load(std::memory_order_acquire);
+    }
+
+private:
+    std::atomic<bool> m_enabled {false};
+    std::atomic<bool> m_paused {false};
+};
+
+#endif // FLOWCONTROL_H
@@ -0,0 +1,51 @@
+#include "flushscheduler.h"
+#include <algorithm>
+
+void FlushScheduler::configure(const int maxInterval, const int latencyTarget, const int batchSize, const bool adaptive)
+{
+    m_maxInterval = std::max(MinInterval, maxInterval);
+    m_latencyTarget = std::max(MinInterval, latencyTarget);
+    m_batchSize = static_cast<size_t>(std::max(0, batchSize));
+    m_adaptive = adaptive;
+    m_interval = adaptive ? ceiling() : m_maxInterval;
+}
+
+int FlushScheduler::armDelay() const
+{
+    return m_interval;
+}
+
+size_t FlushScheduler::batchLimit(const size_t depth) const
+{
+    if (m_batchSize == 0 || !m_adaptive)
+        return m_batchSize;
+
+    // Spread the backlog over the flushes that fit into the latency target
+    const size_t flushesPerTarget = static_cast<size_t>(std::max(1, m_latencyTarget / m_interval));
+    return std::max(m_batchSize, (depth + flushesPerTarget - 1) / flushesPerTarget);
+}
+
+int FlushScheduler::afterFlush(const qint64 oldestAgeUs, const size_t flushed, const size_t depth)
+{
+    if (!m_adaptive)
+        return m_maxInterval;
+
+    const qint64 targetUs = qint64(m_latencyTarget) * 1000;
+    if (oldestAgeUs > targetUs / 2)
+        m_interval = std::max(MinInterval, m_interval / 2);
+    else if (oldestAgeUs < targetUs / 4)
+        m_interval = std::min(ceiling(), m_interval + std::max(1, m_interval / 4));
+
+    if (depth == 0)
+        return Idle;
+
+    // Work is left: come back sooner the more is waiting compared to what one flush took
+    const size_t perFlush = std::max<size_t>(flushed, 1);
+    return static_cast<int>(m_interval / static_cast<qint64>(1 + depth / perFlush));
+}
+
+// A message may wait a whole interval before it is flushed, half of the target leaves room for the rest
+int FlushScheduler::ceiling() const
+{
+    return std::max(MinInterval, std::min(m_maxInterval, m_latencyTarget / 2));
+}
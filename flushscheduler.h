@@ -0,0 +1,49 @@
+#ifndef FLUSHSCHEDULER_H
+#define FLUSHSCHEDULER_H
+
+#include <QtGlobal>
+#include <cstddef>
+
+// Decides when the Logger flushes next and how many messages a flush may take.
+//
+// Fixed mode keeps the old behaviour: one flush every maxInterval ms with the
+// configured batch size.
+//
+// Adaptive mode steers the time a message waits in the buffer, measured on the
+// oldest message of every flush (an upper bound of the p99 of that batch),
+// towards the latency target: the interval is halved whenever that age exceeds
+// half of the target and relaxed again in small steps, up to maxInterval, while
+// it stays below a quarter of it. A backlog shortens the delay to the next flush
+// and raises the batch limit, so it is spread over the flushes that fit into the
+// target. When a flush empties the buffer no timer is kept running; the next
+// arriving message arms it again.
+class FlushScheduler
+{
+public:
+    static constexpr int Idle {-1};
+    static constexpr int MinInterval {1};
+
+    void configure(const int maxInterval, const int latencyTarget, const int batchSize, const bool adaptive);
+
+    // Delay in ms before the first flush once a message arrives in an empty buffer
+    int armDelay() const;
+
+    // Maximum number of messages for the next flush, 0 = no limit
+    size_t batchLimit(const size_t depth) const;
+
+    // Feedback after a flush: age of its oldest message, number of messages it
+    // took and what is left. Returns the delay in ms to the next flush or Idle.
+    int afterFlush(const qint64 oldestAgeUs, const size_t flushed, const size_t depth);
+
+private:
+    int ceiling() const;
+
+private:
+    int m_maxInterval {200};
+    int m_latencyTarget {50};
+    size_t m_batchSize {0};
+    bool m_adaptive {false};
+    int m_interval {200};
+};
+
+#endif // FLUSHSCHEDULER_H
@@ -0,0 +1,119 @@
+#include "lineframer.h"
+#include <QIODevice>
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+// A producer that never sends a newline must not grow the buffer forever
+constexpr qsizetype s_maxLineLength {1024 * 1024};
+}
+
+LineFramer::LineFramer(const qsizetype initialCapacity)
+    : m_data{std::make_unique_for_overwrite<char[]>(initialCapacity)},
+    m_capacity{initialCapacity}
+{
+}
+
+qint64 LineFramer::readFrom(QIODevice *device)
+{
+    const qint64 available = device->bytesAvailable();
+    if (available <= 0)
+        return 0;
+
+    char *dst = prepareWrite(available);
+    const qint64 bytesRead = device->read(dst, writableBytes());
+    if (bytesRead <= 0)
+        return 0;
+
+    commitWrite(bytesRead);
+    return bytesRead;
+}
+
+char *LineFramer::prepareWrite(const qsizetype minFree)
+{
+    reserve(minFree);
+    return m_data.get() + m_tail;
+}
+
+void LineFramer::commitWrite(const qsizetype bytes)
+{
+    m_tail = std::min(m_tail + bytes, m_capacity);
+}
+
+qsizetype LineFramer::writableBytes() const
+{
+    return m_capacity - m_tail;
+}
+
+bool LineFramer::nextLine(QByteArrayView &line)
+{
+    if (m_scan >= m_tail)
+        return false;
+
+    const char *base = m_data.get();
+    const void *newline = std::memchr(base + m_scan, '\n', static_cast<size_t>(m_tail - m_scan));
+    if (!newline)
+    {
+        m_scan = m_tail;
+        return false;
+    }
+
+    const qsizetype end = static_cast<const char *>(newline) - base;
+    line = QByteArrayView(base + m_head, end - m_head);
+    m_head = end + 1;
+    m_scan = m_head;
+
+    if (m_head == m_tail)
+    {
+        // Everything consumed, rewind for free. The view above is still valid
+        // because nothing gets written before the next prepareWrite().
+        m_head = m_scan = m_tail = 0;
+    }
+    return true;
+}
+
+qsizetype LineFramer::pendingBytes() const
+{
+    return m_tail - m_head;
+}
+
+void LineFramer::clear()
+{
+    m_head = m_scan = m_tail = 0;
+}
+
+void LineFramer::reserve(const qsizetype minFree)
+{
+    if (m_capacity - m_tail >= minFree)
+        return;
+
+    const qsizetype pending = m_tail - m_head;
+    if (pending > s_maxLineLength)
+    {
+        qWarning() << "Discarding" << pending << "bytes without line terminator from client";
+        clear();
+        return reserve(minFree);
+    }
+
+    if (pending + minFree <= m_capacity)
+    {
+        // Only the unfinished line is moved, it is at most one message long
+        std::memmove(m_data.get(), m_data.get() + m_head, static_cast<size_t>(pending));
+    }
+    else
+    {
+        qsizetype newCapacity = std::max(m_capacity, qsizetype{256});
+        while (newCapacity < pending + minFree)
+            newCapacity *= 2;
+
+        auto newData = std::make_unique_for_overwrite<char[]>(newCapacity);
+        std::memcpy(newData.get(), m_data.get() + m_head, static_cast<size_t>(pending));
+        m_data = std::move(newData);
+        m_capacity = newCapacity;
+    }
+
+    m_scan -= m_head;
+    m_tail = pending;
+    m_head = 0;
+}
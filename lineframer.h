@@ -0,0 +1,53 @@
+#ifndef LINEFRAMER_H
+#define LINEFRAMER_H
+
+#include <QByteArrayView>
+#include <memory>
+
+class QIODevice;
+
+// Per-connection framing engine for newline delimited messages.
+// Incoming bytes are read straight into the spare capacity of one contiguous
+// buffer. A scan cursor remembers how far the newline search already got, so
+// no byte is scanned twice, and complete lines are handed out as views into
+// the buffer instead of copies. Consumed space is reclaimed lazily: when the
+// buffer runs empty the cursors simply rewind, otherwise only the unfinished
+// tail line is moved to the front before the next read.
+class LineFramer
+{
+public:
+    explicit LineFramer(const qsizetype initialCapacity = 4096);
+
+    LineFramer(const LineFramer&) = delete;
+    LineFramer& operator=(const LineFramer&) = delete;
+    LineFramer(LineFramer&&) noexcept = default;
+    LineFramer& operator=(LineFramer&&) noexcept = default;
+
+    // Reads everything the device has buffered. Returns the number of bytes appended.
+    qint64 readFrom(QIODevice *device);
+
+    // Low level access for callers that read from a raw descriptor:
+    // reserve at least minFree writable bytes, write into them, then commit.
+    char *prepareWrite(const qsizetype minFree);
+    void commitWrite(const qsizetype bytes);
+    qsizetype writableBytes() const;
+
+    // Hands out the next complete line (without the '\n'). The view stays valid
+    // until the next call to readFrom() or prepareWrite().
+    bool nextLine(QByteArrayView &line);
+
+    qsizetype pendingBytes() const;
+    void clear();
+
+private:
+    void reserve(const qsizetype minFree);
+
+private:
+    std::unique_ptr<char[]> m_data;
+    qsizetype m_capacity {0};
+    qsizetype m_head {0};   // first byte not yet handed out
+    qsizetype m_scan {0};   // bytes in [m_head, m_scan) are known to hold no '\n'
+    qsizetype m_tail {0};   // end of valid data
+};
+
+#endif // LINEFRAMER_H
@@ -0,0 +1,223 @@
+#include "logcompressor.h"
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QtEndian>
+#include <algorithm>
+
+namespace {
+const QStringList s_segmentFilters {"logger_*.txt", "logger_*.txt.qz", "logger_*.evlog"};
+constexpr auto s_textSuffix {".txt"};
+constexpr auto s_compressedSuffix {".qz"};
+constexpr auto s_partSuffix {".part"};
+}
+
+LogCompressor::LogCompressor(const QString &directory, QObject *parent)
+    : QThread(parent),
+    m_directory(directory) {}
+
+LogCompressor::~LogCompressor()
+{
+    stop();
+    wait();
+}
+
+void LogCompressor::setPolicy(const Policy &policy)
+{
+    QMutexLocker locker(&m_mutex);
+    m_policy = policy;
+    m_policy.keepFiles = std::max(policy.keepFiles, 0);
+    m_policy.keepBytes = std::max<qint64>(policy.keepBytes, 0);
+}
+
+void LogCompressor::segmentOpened(const QString &path)
+{
+    QMutexLocker locker(&m_mutex);
+    m_activeSegments.insert(QFileInfo(path).absoluteFilePath());
+}
+
+void LogCompressor::segmentClosed(const QString &path)
+{
+    const QString segment = QFileInfo(path).absoluteFilePath();
+    QMutexLocker locker(&m_mutex);
+    m_activeSegments.remove(segment);
+    // binary segments compress their blocks themselves
+    if (m_policy.compress && segment.endsWith(s_textSuffix))
+        m_pending.append(segment);
+    m_retentionDue = true;
+    m_wait.wakeOne();
+}
+
+void LogCompressor::scan()
+{
+    QMutexLocker locker(&m_mutex);
+    m_scanDue = true;
+    m_wait.wakeOne();
+}
+
+void LogCompressor::stop()
+{
+    QMutexLocker locker(&m_mutex);
+    m_stopping = true;
+    m_wait.wakeOne();
+}
+
+void LogCompressor::run()
+{
+    while (true)
+    {
+        QMutexLocker locker(&m_mutex);
+        while (m_pending.isEmpty() && !m_scanDue && !m_retentionDue && !m_stopping)
+            m_wait.wait(&m_mutex);
+        if (m_stopping)
+            break;
+
+        if (m_scanDue)
+        {
+            m_scanDue = false;
+            m_retentionDue = true;
+            const bool compress = m_policy.compress;
+            locker.unlock();
+            const QStringList segments = compress ? segmentFiles() : QStringList();
+            locker.relock();
+            for (const QString &segment : segments)
+            {
+                if (segment.endsWith(s_textSuffix) && !m_activeSegments.contains(segment) && !m_pending.contains(segment))
+                    m_pending.append(segment);
+            }
+        }
+        else if (!m_pending.isEmpty())
+        {
+            // one file at a time, so stop() and new segments are noticed in between
+            const QString path = m_pending.takeFirst();
+            locker.unlock();
+            compressFile(path);
+        }
+        else
+        {
+            m_retentionDue = false;
+            locker.unlock();
+            applyRetention();
+        }
+    }
+}
+
+bool LogCompressor::compressFile(const QString &path)
+{
+    QFile in(path);
+    if (!in.open(QIODevice::ReadOnly))
+        return false;      // removed by the retention meanwhile
+
+    const QString target = path + s_compressedSuffix;
+    QFile out(target + s_partSuffix);
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning() << "Cannot compress log segment" << path << out.errorString();
+        return false;
+    }
+
+    while (!in.atEnd())
+    {
+        {
+            QMutexLocker locker(&m_mutex);
+            if (m_stopping)
+            {
+                out.remove();
+                return false;
+            }
+        }
+        const QByteArray packed = qCompress(in.read(ChunkSize));
+        const quint32 size = qToBigEndian(quint32(packed.size()));
+        if (out.write(reinterpret_cast<const char *>(&size), sizeof(size)) != qint64(sizeof(size))
+            || out.write(packed) != packed.size())
+        {
+            qWarning() << "Cannot compress log segment" << path << out.errorString();
+            out.remove();
+            return false;
+        }
+    }
+    out.close();
+    in.close();
+
+    QFile::remove(target);
+    if (!QFile::rename(target + s_partSuffix, target))
+    {
+        qWarning() << "Cannot rename" << target + s_partSuffix;
+        return false;
+    }
+    QFile::remove(path);
+    qDebug() << "Compressed log segment" << path << "to" << QFileInfo(target).size() << "bytes";
+    return true;
+}
+
+void LogCompressor::applyRetention()
+{
+    Policy policy;
+    QSet<QString> active;
+    {
+        QMutexLocker locker(&m_mutex);
+        policy = m_policy;
+        active = m_activeSegments;
+    }
+
+    QDir dir(m_directory);
+    // compression happens on this thread only, a .part seen here was left by a crash
+    for (const QString &part : dir.entryList({QString("logger_*") + s_partSuffix}, QDir::Files))
+        dir.remove(part);
+
+    if (policy.keepFiles == 0 && policy.keepBytes == 0)
+        return;
+
+    const QFileInfoList files = dir.entryInfoList(s_segmentFilters, QDir::Files, QDir::Name);
+    qsizetype count = files.size();
+    qint64 total {0};
+    for (const QFileInfo &file : files)
+        total += file.size();
+
+    for (const QFileInfo &file : files)
+    {
+        if ((policy.keepFiles == 0 || count <= policy.keepFiles) && (policy.keepBytes == 0 || total <= policy.keepBytes))
+            break;
+        const QString path = file.absoluteFilePath();
+        if (active.contains(path) || !QFile::remove(path))
+            continue;
+        --count;
+        total -= file.size();
+        qDebug() << "Removed log segment" << path << "for the retention limits";
+
+        QMutexLocker locker(&m_mutex);
+        m_pending.removeAll(path);
+    }
+}
+
+// Every segment in the directory, oldest first
+QStringList LogCompressor::segmentFiles() const
+{
+    QStringList segments;
+    const QFileInfoList files = QDir(m_directory).entryInfoList(s_segmentFilters, QDir::Files, QDir::Name);
+    for (const QFileInfo &file : files)
+        segments.append(file.absoluteFilePath());
+    return segments;
+}
+
+bool LogCompressor::decompress(const QString &path, QIODevice &out)
+{
+    QFile in(path);
+    if (!in.open(QIODevice::ReadOnly))
+        return false;
+
+    while (!in.atEnd())
+    {
+        quint32 size {0};
+        if (in.read(reinterpret_cast<char *>(&size), sizeof(size)) != qint64(sizeof(size)))
+            return false;
+        const QByteArray packed = in.read(qFromBigEndian(size));
+        if (packed.size() != qsizetype(qFromBigEndian(size)))
+            return false;
+        const QByteArray text = qUncompress(packed);
+        if (text.isEmpty() || out.write(text) != text.size())
+            return false;
+    }
+    return true;
+}
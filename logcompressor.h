@@ -0,0 +1,80 @@
+#ifndef LOGCOMPRESSOR_H
+#define LOGCOMPRESSOR_H
+
+#include <QIODevice>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <QWaitCondition>
+
+// Compresses closed log segments and keeps the logs directory within the
+// retention limits, on a thread of idle priority.
+//
+// The Writer only hands over the path of a segment it has closed, so writing
+// the active segment never waits for compression or deletion. A compressed
+// segment <name>.txt.qz is a sequence of chunks, each a 32 bit big-endian
+// length followed by qCompress() of up to ChunkSize bytes of the text, so
+// memory use does not depend on the segment size; decompress() restores it,
+// and evlog_convert uses it to print such segments.
+// The file is written as <name>.txt.qz.part and renamed when complete, the
+// original is removed after that.
+//
+// Binary segments (.evlog) are compressed per block already and left as they are.
+// Retention counts every logger_*.txt, .txt.qz and .evlog in the directory,
+// oldest (by name, which starts with the timestamp) first, and removes closed
+// segments until both the file count and the total size are within the limits.
+// The active segments count but are never removed.
+class LogCompressor : public QThread
+{
+    Q_OBJECT
+
+public:
+    static constexpr qsizetype ChunkSize {4 * 1024 * 1024};
+
+    struct Policy {
+        bool compress {true};
+        int keepFiles {0};          // 0 = no limit
+        qint64 keepBytes {0};       // 0 = no limit
+    };
+
+    explicit LogCompressor(const QString &directory, QObject *parent = nullptr);
+    ~LogCompressor();
+
+    LogCompressor(const LogCompressor&) = delete;
+    LogCompressor& operator=(const LogCompressor&) = delete;
+
+    // Any thread
+    void setPolicy(const Policy &policy);
+    // The Writer's streams announce a segment before creating it and hand it over once closed
+    void segmentOpened(const QString &path);
+    void segmentClosed(const QString &path);
+    // Compresses whatever closed segment is left uncompressed and applies the retention
+    void scan();
+    // Stops after the file in progress, the rest is picked up by the next scan()
+    void stop();
+
+    static bool decompress(const QString &path, QIODevice &out);
+
+protected:
+    void run() override;
+
+private:
+    bool compressFile(const QString &path);
+    void applyRetention();
+    QStringList segmentFiles() const;
+
+private:
+    const QString m_directory;
+    QMutex m_mutex;
+    QWaitCondition m_wait;
+    Policy m_policy;
+    QSet<QString> m_activeSegments;
+    QStringList m_pending;
+    bool m_scanDue {false};
+    bool m_retentionDue {false};
+    bool m_stopping {false};
+};
+
+#endif // LOGCOMPRESSOR_H
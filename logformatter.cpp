@@ -0,0 +1,45 @@
+#include "logformatter.h"
+#include <QDateTime>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+namespace {
+
+constexpr qint64 s_microsPerSecond {1000000};
+
+// Rounds towards negative infinity, timestamps before 1970 still fall into the right second
+inline qint64 floorDiv(const qint64 value, const qint64 divisor)
+{
+    const qint64 quotient = value / divisor;
+    return (value % divisor < 0) ? quotient - 1 : quotient;
+}
+
+} // namespace
+
+void LogFormatter::append(QByteArray &out, const EventMessage &msg)
+{
+    const qint64 second = floorDiv(msg.timestamp, s_microsPerSecond);
+    if (!m_secondValid || second != m_secondEpoch)
+    {
+        const QByteArray text = QDateTime::fromSecsSinceEpoch(second).toString("yyyy-MM-dd HH:mm:ss").toLatin1();
+        std::memset(m_second, ' ', SecondLength);
+        std::memcpy(m_second, text.constData(), std::min<qsizetype>(text.size(), SecondLength));
+        m_secondEpoch = second;
+        m_secondValid = true;
+    }
+
+    char number[16];
+    const char *numberEnd = std::to_chars(number, number + sizeof(number), msg.clientId).ptr;
+    const QLatin1String severity = severityName(msg.severity);
+    const QByteArrayView text = msg.text.utf8();
+
+    out.append(m_second, SecondLength);
+    out.append(" Module ");
+    out.append(number, numberEnd - number);
+    out.append(" [");
+    out.append(severity.data(), severity.size());
+    out.append("]: ");
+    out.append(text.data(), text.size());
+    out.append('\n');
+}
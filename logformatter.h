@@ -0,0 +1,27 @@
+#ifndef LOGFORMATTER_H
+#define LOGFORMATTER_H
+
+#include <QByteArray>
+#include "eventmessage.h"
+
+// Formats messages into the text layout of the log file,
+//   "yyyy-MM-dd HH:mm:ss Module <id> [<TYPE>]: <text>\n"
+// appending straight to a byte buffer. A batch mostly stays within one second,
+// so the local date and time of the last second is cached and only a new
+// second goes through QDateTime; the rest is plain byte copies and digits.
+class LogFormatter
+{
+public:
+    LogFormatter() = default;
+
+    void append(QByteArray &out, const EventMessage &msg);
+
+private:
+    static constexpr qsizetype SecondLength {19};   // yyyy-MM-dd HH:mm:ss
+
+    char m_second[SecondLength] {};
+    qint64 m_secondEpoch {0};
+    bool m_secondValid {false};
+};
+
+#endif // LOGFORMATTER_H
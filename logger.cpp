@@ -1,87 +1,394 @@
 #include "logger.h"
 #include <QDir>
+#include <QFileInfo>
 #include <QTextStream>
-#include <QDateTime>
 #include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QDeadlineTimer>
+#include <algorithm>
+#include <limits>
 
 namespace {
-constexpr int s_flushIntAfterStop {10};
+constexpr qsizetype s_displayCapacity {2000};
+constexpr auto s_spillFileName {"logger_spill.bin"};
+constexpr auto s_writerSpillFileName {"writer_spill.bin"};
+constexpr size_t s_drainBatchSize {4096};
 }
 
 Logger::Logger(QObject *parent)
     : QObject(parent),
-    m_maxSize(500),
-    m_flushInterval(200)
+    m_flushTimer(this),
+    m_flowControl{std::make_shared<FlowControl>()},
+    m_stats{std::make_shared<LoggerStats>()},
+    m_displaySink{std::make_shared<SinkQueue>(SinkPolicy{s_displayCapacity, 0, SinkDropPolicy::DropOldest, 1})}
 {
-    m_flushTimer.setInterval(m_flushInterval);
+    m_displaySink->setNotifier([this]() { emit displayReady(); });
+    addSink(m_displaySink);
+    m_clock.start();
+    m_scheduler.configure(m_settings.flushInterval, m_settings.latencyTarget,
+                          m_settings.flushBatchSize, m_settings.adaptiveFlush);
+    m_flushTimer.setSingleShot(true);
     connect(&m_flushTimer, &QTimer::timeout, this, &Logger::flushBuffer);
-    m_flushTimer.start();
+    m_flushTimer.start(m_scheduler.armDelay());
 }
 
 Logger::~Logger() {
     if (m_logWriter) {
+        postWriterBacklog(true);
         m_logWriter->finish();
         m_logWriter->wait();
         m_logWriter.reset();
     }
+    // segments left uncompressed are picked up by the scan of the next run
+    m_compressor.reset();
+    // whatever is still spilled stays in the file for the next run
+    m_spill.close();
     clear();
 }
 
 void Logger::addMessage(const EventMessage &msg) {
-    qDebug() << "Added message to buffer:" << msg.clientId << msg.type << msg.text;
-    if (m_buffer.size() >= m_maxSize){
-        auto it = std::find_if(m_buffer.begin(), m_buffer.end(), [](const EventMessage &m) {
-            return m.type == "DATA";
-        });
-        if (it != m_buffer.end()) {
-            m_buffer.erase(it);  // Drop first DATA message, as they are lower prio
-        } else if (msg.type == "WARNING") {
-            auto it = std::find_if(m_buffer.begin(), m_buffer.end(), [](const EventMessage &m) {
-                return m.type == "INFO" || m.type == "INFO";
-            });
-            if (it != m_buffer.end())
-                m_buffer.erase(it); // Drop first INFO message if there is a warning
-        } else if (msg.type == "ERROR") {
-                auto it = std::find_if(m_buffer.begin(), m_buffer.end(), [](const EventMessage &m) {
-                    return m.type == "INFO" || m.type == "WARNING";
-                });
-                if (it != m_buffer.end())
-                    m_buffer.erase(it); // Drop first INFO or WARNING message if there is a error
-        } else if (msg.type == "CRITICAL"){
-            // If the message is CRITICAL drop an ERROR, if it exists
-            it = std::find_if(m_buffer.begin(), m_buffer.end(), [](const EventMessage &m) {
-                return m.type == "INFO" || m.type == "WARNING" || m.type == "ERROR";
-            });
-            if (it != m_buffer.end()){
-                m_buffer.erase(it); // Drop any message that is not critical to display critical
-            } else {
-            // If no other DATA/INFO/WARNING/ERROR message exists, and the message is CRITICAL dont drop anything
-            // but also dont add it to the queue because its full
-                return;
+    qDebug() << "Added message to buffer:" << msg.clientId << severityName(msg.severity) << msg.text.toString();
+    const qint64 now = m_clock.nsecsElapsed() / 1000;
+    m_stats->countAccepted(msg);
+    if (m_settings.coalesceEnabled) {
+        takeSummaries(now, false);
+        if (m_coalescer.admit(msg, now)) {
+            bufferMessage(msg, now);
+        } else {
+            m_stats->countFolded(msg);
+        }
+    } else {
+        bufferMessage(msg, now);
+    }
+
+    // An idle adaptive scheduler has no timer running
+    if (!m_flushTimer.isActive()) {
+        scheduleFlush(m_scheduler.armDelay());
+    }
+}
+
+void Logger::bufferMessage(const EventMessage &msg, const qint64 now) {
+    if (m_flowControl->isEnabled()) {
+        // Lossless: what is already in flight is taken, the gate stops the rest
+        m_buffer.push(msg, now);
+        updateFlowControl();
+    } else if (!spill(msg)) {
+        if (m_buffer.size() >= static_cast<size_t>(m_settings.maxSize)) {
+            // The module with the largest backlog pays for the overflow, then the sender itself
+            const uint32_t heaviest = m_buffer.heaviestClient();
+            if (!evictFor(msg, heaviest) && (heaviest == msg.clientId || !evictFor(msg, msg.clientId))) {
+                // If no DATA/INFO/WARNING/ERROR message exists dont drop anything,
+                // but also dont add the CRITICAL message to the queue because its full
+                if (msg.severity == Severity::Critical) {
+                    m_stats->countRejected(msg);
+                    return;
+                }
             }
         }
+        m_buffer.push(msg, now);
     }
-    m_buffer.push_back(msg);
+    m_stats->setDepth(m_buffer.size());
+}
+
+// Buffers the "repeated N times" entries of the coalescing windows that are over
+void Logger::takeSummaries(const qint64 now, const bool flushAll) {
+    EventMessageBatch summaries;
+    m_coalescer.takeExpired(now, summaries, flushAll);
+    // a summary is a message of its own in the accounting, the repeats in it were counted as folded
+    for (const EventMessage &summary : summaries) {
+        m_stats->countAccepted(summary);
+        bufferMessage(summary, now);
+    }
+}
+
+// Past maxSize, and as long as older messages wait on disk, messages go to the spill file
+bool Logger::spill(const EventMessage &msg) {
+    if (!m_settings.spillEnabled || !m_spill.isOpen())
+        return false;
+    if (m_spill.empty() && m_buffer.size() < static_cast<size_t>(m_settings.maxSize))
+        return false;
+    // a full spill file falls back to evicting
+    return m_spill.push(msg);
+}
+
+void Logger::refillFromSpill() {
+    const qint64 now = m_clock.nsecsElapsed() / 1000;
+    EventMessage msg;
+    while (m_buffer.size() < static_cast<size_t>(m_settings.maxSize) && m_spill.pop(msg)) {
+        m_buffer.push(msg, now);
+    }
+}
+
+// Drops one message of victim to make room for msg, by the severity rules
+bool Logger::evictFor(const EventMessage &msg, const uint32_t victim) {
+    Severity evicted {Severity::Data};
+    bool dropped {false};
+    // Drop the oldest DATA message, as they are lower prio
+    if (m_buffer.evictOldest(victim, {Severity::Data}, &evicted)) {
+        dropped = true;
+    } else if (msg.severity == Severity::Warning) {
+        dropped = m_buffer.evictOldest(victim, {Severity::Info}, &evicted);
+    } else if (msg.severity == Severity::Error) {
+        dropped = m_buffer.evictOldest(victim, {Severity::Info, Severity::Warning}, &evicted);
+    } else if (msg.severity == Severity::Critical) {
+        dropped = m_buffer.evictOldest(victim, {Severity::Info, Severity::Warning, Severity::Error}, &evicted);
+    }
+    if (dropped) {
+        m_stats->countEvicted(victim, evicted);
+    }
+    return dropped;
 }
 
 void Logger::flushBuffer() {
-    if (!m_buffer.empty()) {
-        EventMessage const msg = m_buffer.front();
-        emit messageReady(msg);
-        m_buffer.pop_front();
-        if (m_logWriter) {
-            m_logWriter->enqueue(msg);
+    takeSummaries(m_clock.nsecsElapsed() / 1000, false);
+    refillFromSpill();
+    // what the Writer refused before goes first, the room notifier flushes again once it can
+    const bool writerAccepts = postWriterBacklog(false);
+    if (m_buffer.empty()) {
+        updateWriterStats();
+        scheduleFlush(m_scheduler.afterFlush(0, 0, 0));
+        return;
+    }
+    if (!writerAccepts && holdsBackForWriter() && m_writerBacklog.size() >= std::max(1, m_settings.maxSize)) {
+        // The backlog is full too: the messages stay here, under the buffer's own
+        // spill or flow control, until the room notifier flushes again
+        m_flushTimer.stop();
+        updateWriterStats();
+        return;
+    }
+
+    const size_t batchLimit = m_scheduler.batchLimit(m_buffer.size());
+    const size_t limit = batchLimit > 0 ? std::min(m_buffer.size(), batchLimit) : m_buffer.size();
+    const qint64 budgetNs = qint64(m_settings.flushTimeBudget) * 1000;
+    QElapsedTimer elapsed;
+    elapsed.start();
+
+    EventMessageBatch batch;
+    batch.reserve(limit);
+    // Round robin order is not arrival order, the oldest message may come at any position
+    qint64 oldestEnqueuedAt {std::numeric_limits<qint64>::max()};
+    qint64 enqueuedAt {0};
+    do {
+        batch.append(m_buffer.takeNext(&enqueuedAt));
+        oldestEnqueuedAt = std::min(oldestEnqueuedAt, enqueuedAt);
+    } while (static_cast<size_t>(batch.size()) < limit && (budgetNs == 0 || elapsed.nsecsElapsed() < budgetNs));
+
+    const std::shared_ptr<LogSink> writerSink = m_logWriter ? m_logWriter->sink() : nullptr;
+    for (const std::shared_ptr<LogSink> &sink : m_sinks) {
+        if (sink == writerSink && !writerAccepts) {
+            holdForWriter(batch);
+        } else {
+            sink->post(batch);
         }
     }
+    refillFromSpill();
+    updateFlowControl();
+    m_stats->setDepth(m_buffer.size());
+    updateWriterStats();
+
+    const qint64 oldestAge = m_clock.nsecsElapsed() / 1000 - oldestEnqueuedAt;
+    scheduleFlush(m_scheduler.afterFlush(oldestAge, static_cast<size_t>(batch.size()), m_buffer.size()));
+}
+
+void Logger::scheduleFlush(const int delay)
+{
+    if (delay == FlushScheduler::Idle) {
+        // nothing to flush, but a coalescing window may still owe its summary
+        const qint64 summaryIn = m_coalescer.nextSummaryIn(m_clock.nsecsElapsed() / 1000);
+        if (summaryIn >= 0) {
+            m_flushTimer.start(static_cast<int>(std::min<qint64>(summaryIn / 1000 + 1, std::numeric_limits<int>::max())));
+        } else {
+            m_flushTimer.stop();
+        }
+    } else {
+        m_flushTimer.start(delay);
+    }
+}
+
+void Logger::drainForShutdown(const int deadlineMs)
+{
+    QElapsedTimer elapsed;
+    elapsed.start();
+    const QDeadlineTimer deadline(std::max(0, deadlineMs));
+    DrainReport report;
+
+    // what the receivers published last and the summaries of all open coalescing windows
+    drainMessageRing();
+    takeSummaries(m_clock.nsecsElapsed() / 1000, true);
+
+    refillFromSpill();
+    if (m_logWriter && !m_writerBacklog.isEmpty() && m_logWriter->sink()->waitForRoom(deadline)) {
+        postWriterBacklog(true);
+    }
+    while (!m_buffer.empty() && !deadline.hasExpired()) {
+        if (m_logWriter && !m_logWriter->sink()->waitForRoom(deadline)) {
+            break;
+        }
+        const size_t count = std::min(m_buffer.size(), s_drainBatchSize);
+        EventMessageBatch batch;
+        batch.reserve(static_cast<qsizetype>(count));
+        for (size_t i = 0; i < count; ++i) {
+            batch.append(m_buffer.takeNext());
+        }
+        for (const std::shared_ptr<LogSink> &sink : m_sinks) {
+            sink->post(batch);
+        }
+        report.flushed += static_cast<quint64>(batch.size());
+        refillFromSpill();
+    }
+
+    // Past the deadline the buffer is given up, the spill file keeps its messages for the next run
+    logClientShares();
+    report.abandoned = m_buffer.size() + static_cast<quint64>(m_writerBacklog.size());
+    report.spilled = m_spill.size();
+    m_buffer.discardAll([this](const EventMessage &msg) {
+        m_stats->countEvicted(msg.clientId, msg.severity);
+    });
+    for (const EventMessage &msg : std::as_const(m_writerBacklog)) {
+        m_stats->countEvicted(msg.clientId, msg.severity);
+    }
+    m_writerBacklog.clear();
+    updateFlowControl();
+    m_stats->setDepth(0);
+
+    if (m_logWriter) {
+        report.synced = m_logWriter->sync(deadline, report.unwritten);
+        updateWriterStats();
+    }
+    report.elapsedMs = elapsed.elapsed();
+    scheduleFlush(m_scheduler.afterFlush(0, 0, 0));
+    emit flushedAfterStop(report);
+}
+
+void Logger::setMessageRing(std::shared_ptr<EventMessageRing> ring)
+{
+    if (m_messageRing == ring)
+        return;
+    drainMessageRing();
+    m_messageRing = std::move(ring);
+}
+
+void Logger::drainMessageRing()
+{
+    if (!m_messageRing)
+        return;
+
+    // Clear the flag first: whatever gets pushed from now on triggers a new wakeup
+    m_messageRing->acknowledgeWakeup();
+    EventMessageBatch batch;
+    EventMessage msg;
+    while (m_messageRing->tryPop(msg)) {
+        addMessage(msg);
+        batch.append(std::move(msg));
+    }
+    if (!batch.isEmpty()) {
+        emit messagesIngested(batch);
+    }
+}
+
+void Logger::ingestMessages(const EventMessageBatch &batch)
+{
+    // anything already published through the ring is older than this batch
+    drainMessageRing();
+    for (const EventMessage &msg : batch) {
+        addMessage(msg);
+    }
+    emit messagesIngested(batch);
+}
+
+void Logger::logClientShares() const
+{
+    quint64 total {0};
+    const std::vector<MessageQueue::ClientShare> shares = m_buffer.clientShares();
+    for (const MessageQueue::ClientShare &share : shares) {
+        total += share.flushed;
+    }
+    for (const MessageQueue::ClientShare &share : shares) {
+        qDebug() << "Module" << share.clientId << "flushed" << share.flushed << "messages,"
+                 << (total > 0 ? 100.0 * double(share.flushed) / double(total) : 0.0) << "% of the output,"
+                 << share.evicted << "evicted";
+    }
 }
 
 void Logger::clear() {
     m_buffer.clear();
+    m_coalescer.clear();
+}
+
+void Logger::updateFlowControl()
+{
+    const bool paused = m_flowControl->isPaused();
+    const size_t highWater = static_cast<size_t>(std::max(1, m_settings.maxSize));
+    if (!paused && m_flowControl->isEnabled() && m_buffer.size() >= highWater) {
+        qDebug() << "Logger queue reached" << m_buffer.size() << "messages, pausing the receivers";
+        m_flowControl->setPaused(true);
+    } else if (paused && (!m_flowControl->isEnabled() || m_buffer.size() <= highWater / 2)) {
+        qDebug() << "Logger queue drained to" << m_buffer.size() << "messages, resuming the receivers";
+        m_flowControl->setPaused(false);
+        emit readingResumed();
+    }
+}
+
+void Logger::applySettings(const LoggerSettings &settings)
+{
+    // modules dropped from the weights fall back to 1
+    for (auto it = m_settings.clientWeights.cbegin(); it != m_settings.clientWeights.cend(); ++it) {
+        if (!settings.clientWeights.contains(it.key())) {
+            m_buffer.setClientWeight(it.key(), 1);
+        }
+    }
+    m_settings = settings;
+    m_settings.flushBatchSize = std::max(0, m_settings.flushBatchSize);
+    m_settings.flushTimeBudget = std::max(0, m_settings.flushTimeBudget);
+    m_flowControl->setEnabled(m_settings.flowControlEnabled);
+    updateFlowControl();
+    m_displaySink->setPolicy(SinkPolicy{s_displayCapacity, 0, SinkDropPolicy::DropOldest, m_settings.displayDecimation});
+    m_buffer.setQuantum(m_settings.fairQuantum);
+    for (auto it = m_settings.clientWeights.cbegin(); it != m_settings.clientWeights.cend(); ++it) {
+        m_buffer.setClientWeight(it.key(), it.value());
+    }
+    if (m_settings.spillEnabled && !m_spill.isOpen() && !m_logFilePath.isEmpty()) {
+        m_spill.open(QFileInfo(m_logFilePath).dir().filePath(s_spillFileName),
+                     qint64(m_settings.spillSize) * 1024 * 1024);
+    }
+    configureWriter();
+    m_coalescer.configure(qint64(m_settings.coalesceWindow) * 1000, m_settings.coalesceTemplates);
+    if (!m_settings.coalesceEnabled) {
+        takeSummaries(m_clock.nsecsElapsed() / 1000, true);
+    }
+    m_scheduler.configure(m_settings.flushInterval, m_settings.latencyTarget,
+                          m_settings.flushBatchSize, m_settings.adaptiveFlush);
+    scheduleFlush(m_buffer.empty() ? m_scheduler.afterFlush(0, 0, 0) : m_scheduler.armDelay());
+}
+
+std::shared_ptr<FlowControl> Logger::flowControl() const
+{
+    return m_flowControl;
+}
+
+std::shared_ptr<LoggerStats> Logger::stats() const
+{
+    return m_stats;
+}
+
+std::shared_ptr<SinkQueue> Logger::displaySink() const
+{
+    return m_displaySink;
+}
+
+void Logger::addSink(std::shared_ptr<LogSink> sink)
+{
+    m_sinks.push_back(std::move(sink));
+}
+
+void Logger::removeSink(const std::shared_ptr<LogSink> &sink)
+{
+    m_sinks.erase(std::remove(m_sinks.begin(), m_sinks.end(), sink), m_sinks.end());
 }
 
 bool Logger::isEmpty() const
 {
-    return m_buffer.empty();
+    return m_buffer.empty() && m_spill.empty();
 }
 
 void Logger::startNewLogFile() {
@@ -90,61 +397,131 @@ void Logger::startNewLogFile() {
         logDir.mkpath(".");
     }
 
-    QString const timestamp = QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss");
-    m_logFilePath = logDir.filePath("logger_" + timestamp + ".txt");
-
     if (m_logWriter) {
+        removeSink(m_logWriter->sink());
+        // the old file still gets what its Writer refused
+        postWriterBacklog(true);
         m_logWriter->finish();
         m_logWriter->wait();
         m_logWriter.reset();
     }
+    // per module this only names the directory and the format, the streams add their names
+    m_logFilePath = LogStream::newSegmentPath(logDir.path(), QString(), m_settings.binaryLog ? ".evlog" : ".txt");
+    if (!m_compressor) {
+        m_compressor = std::make_shared<LogCompressor>(logDir.path());
+        m_compressor->start(QThread::IdlePriority);
+    }
+
     m_logWriter = std::make_unique<Writer>(this);
-    qDebug() << "Creating new log file:" << m_logFilePath;
+    addSink(m_logWriter->sink());
+    if (!m_settings.perModuleLogs)
+        qDebug() << "Creating new log file:" << m_logFilePath;
     m_logWriter->setLogFilePath(m_logFilePath);
+    m_logWriter->setBinaryFormat(m_settings.binaryLog);
+    m_logWriter->setCompressor(m_compressor);
+    m_logWriter->setRouting(m_settings.perModuleLogs, m_settings.logGroups);
+    m_logWriter->setThreadCount(m_settings.writerThreads);
+    m_logWriter->sink()->setRoomNotifier([this]() {
+        QMetaObject::invokeMethod(this, [this]() { flushBuffer(); }, Qt::QueuedConnection);
+    });
+    configureWriter();
     m_logWriter->start();
-}
 
-void Logger::logManualStop(uint32_t const moduleId) {
-    EventMessage msg;
-    msg.clientId = moduleId;
-    msg.timestamp = QDateTime::currentDateTime();
-    msg.type = "INFO";
-    msg.text = QString("Module %1 manually stopped by user.").arg(moduleId);
-    if (m_logWriter) {
-        m_logWriter->enqueue(msg);
+    // Messages spilled by a previous run go into the new file first
+    const QString spillPath = logDir.filePath(s_spillFileName);
+    if (m_settings.spillEnabled || m_spill.isOpen() || QFile::exists(spillPath)) {
+        m_spill.open(spillPath, qint64(m_settings.spillSize) * 1024 * 1024);
+        if (!m_spill.empty()) {
+            qDebug() << "Recovered" << m_spill.size() << "spilled messages from" << spillPath;
+            scheduleFlush(m_scheduler.armDelay());
+        }
     }
 }
 
-void Logger::applyFlushIntervalAfterAppStopped()
-{
-    m_flushTimer.stop();
-    m_flushTimer.setInterval(s_flushIntAfterStop);
-    m_flushTimer.start();
+// Posts the backlog to the Writer once its queue has room again; with force
+// regardless, a full Block queue still takes it. False while the queue is full.
+bool Logger::postWriterBacklog(const bool force) {
+    if (!m_logWriter) {
+        return true;
+    }
+    const std::shared_ptr<SinkQueue> sink = m_logWriter->sink();
+    if (!force && !sink->acceptsMore()) {
+        return false;
+    }
+    if (!m_writerBacklog.isEmpty()) {
+        sink->post(m_writerBacklog);
+        m_writerBacklog.clear();
+    }
+    return true;
 }
 
-void Logger::applyFlushInterval()
-{
-    m_flushTimer.stop();
-    m_flushTimer.setInterval(m_flushInterval);
-    m_flushTimer.start();
+// Lossless buffer settings: a full Writer backlog holds the messages in the buffer
+bool Logger::holdsBackForWriter() const {
+    return m_flowControl->isEnabled() || (m_settings.spillEnabled && m_spill.isOpen());
 }
 
-void Logger::setLoggerMaxSize(int const maxSize)
-{
-    m_maxSize = maxSize;
+// Keeps a flushed batch for the Writer while its queue is full. Past maxSize
+// messages the backlog drops like a full buffer: the oldest DATA first, then
+// INFO, WARNING and ERROR; CRITICAL messages are kept. With flow control or the
+// spill file flushBuffer() stops taking messages before it gets that far.
+void Logger::holdForWriter(const EventMessageBatch &batch) {
+    m_writerBacklog.append(batch);
+    if (holdsBackForWriter()) {
+        return;
+    }
+    const qsizetype limit = std::max(1, m_settings.maxSize);
+    for (const Severity severity : {Severity::Data, Severity::Info, Severity::Warning, Severity::Error}) {
+        qsizetype excess = m_writerBacklog.size() - limit;
+        if (excess <= 0) {
+            break;
+        }
+        m_writerBacklog.removeIf([&](const EventMessage &msg) {
+            if (excess == 0 || msg.severity != severity) {
+                return false;
+            }
+            --excess;
+            m_stats->countEvicted(msg.clientId, msg.severity);
+            return true;
+        });
+    }
 }
 
-void Logger::setLoggerFlushInterval(int const flushInterval)
-{
-    m_flushInterval = flushInterval;
+// Queue bound, full policy, fsync interval and rotation of the current Writer,
+// and the compression and retention of the logs directory. Messages a previous
+// run left in the Writer's spill file go into the new log file first.
+void Logger::configureWriter() {
+    if (!m_logWriter) {
+        return;
+    }
+    m_logWriter->setSyncInterval(m_settings.fsyncInterval);
+    m_logWriter->setRotation(qint64(m_settings.rotateSize) * 1024 * 1024, qint64(m_settings.rotateInterval) * 60 * 1000);
+    m_compressor->setPolicy(LogCompressor::Policy{m_settings.compressLogs, m_settings.keepLogFiles,
+                                                  qint64(m_settings.keepLogSize) * 1024 * 1024});
+    m_compressor->scan();
+    const std::shared_ptr<SinkQueue> sink = m_logWriter->sink();
+    sink->setPolicy(SinkPolicy{0, qsizetype(m_settings.writerQueueSize) * 1024 * 1024, m_settings.writerFullPolicy, 1});
+    const QString spillPath = QFileInfo(m_logFilePath).dir().filePath(s_writerSpillFileName);
+    if (m_settings.writerFullPolicy == SinkDropPolicy::Spill || QFile::exists(spillPath)) {
+        if (!sink->openSpill(spillPath, qint64(m_settings.spillSize) * 1024 * 1024)) {
+            qWarning() << "Cannot open the Writer spill file" << spillPath << ", dropping by severity instead";
+        }
+    }
+    updateWriterStats();
 }
 
-int Logger::getLoggerFlushInterval() const
-{
-    return m_flushInterval;
+void Logger::updateWriterStats() {
+    if (m_logWriter) {
+        m_stats->setWriterQueue(m_logWriter->sink()->stats());
+    }
 }
 
-int Logger::getLoggerMaxSize()
-{
-    return m_maxSize;
+void Logger::logManualStop(uint32_t const moduleId) {
+    EventMessage msg;
+    msg.clientId = moduleId;
+    msg.timestamp = currentTimestamp();
+    msg.severity = Severity::Info;
+    msg.text = QString("Module %1 manually stopped by user.").arg(moduleId);
+    if (m_logWriter) {
+        m_logWriter->enqueue(msg);
+    }
 }
@@ -2,44 +2,170 @@
 #define LOGGER_H
 
 #include <QObject>
+#include <QHash>
+#include <QElapsedTimer>
 #include <QTimer>
-#include <deque>
 #include "eventmessage.h"
+#include "messagequeue.h"
+#include "messagecoalescer.h"
+#include "messagering.h"
+#include "spillqueue.h"
+#include "sinkqueue.h"
+#include "flushscheduler.h"
 #include "writer.h"
+#include "flowcontrol.h"
+#include "loggerstats.h"
 #include <memory>
 
+// Logger parameters from the settings dialog
+struct LoggerSettings {
+    int maxSize {500};
+    int flushInterval {200};        // ms, the upper bound in adaptive mode
+    int flushBatchSize {0};         // messages per flush, 0 = the whole queue
+    int flushTimeBudget {2000};     // microseconds per flush, 0 = no limit
+    bool flowControlEnabled {false};
+    bool adaptiveFlush {true};      // see FlushScheduler
+    int latencyTarget {50};         // ms a message may wait in the buffer
+    int fairQuantum {8};            // messages per module and round, see MessageQueue
+    QHash<uint32_t, int> clientWeights; // module id -> weight, 1 if missing
+    bool spillEnabled {false};      // overflow to the spill file instead of evicting
+    int spillSize {64};             // MiB, size of a newly created spill file
+    int displayDecimation {1};      // the display shows every n-th DATA message of a module
+    bool coalesceEnabled {false};   // fold repeated messages, see MessageCoalescer
+    int coalesceWindow {2000};      // ms
+    bool coalesceTemplates {true};  // numbers in the text do not make a message different
+    int shutdownDeadline {5000};    // ms the drain on stop may take
+    int fsyncInterval {Writer::SyncNever}; // ms between fsyncs of the log file, see Writer
+    int writerQueueSize {32};       // MiB of messages waiting for the Writer
+    SinkDropPolicy writerFullPolicy {SinkDropPolicy::Block}; // Block (only the Writer waits), DropBySeverity or Spill
+    int rotateSize {64};            // MiB per log file segment, 0 = no limit
+    int rotateInterval {0};         // minutes per segment, 0 = no limit
+    bool compressLogs {true};       // compress closed segments, see LogCompressor
+    int keepLogFiles {0};           // segments kept in logs/, 0 = no limit
+    int keepLogSize {1024};         // MiB kept in logs/, 0 = no limit
+    bool binaryLog {false};         // .evlog segments instead of text, see BinaryLogWriter
+    bool perModuleLogs {false};     // one log file per module or group, see Writer
+    QHash<uint32_t, QString> logGroups; // module id -> shared log file, own file if missing
+    int writerThreads {2};          // threads writing the per-module files
+};
+
+// Outcome of Logger::drainForShutdown()
+struct DrainReport {
+    quint64 flushed {0};        // messages handed to the sinks
+    quint64 abandoned {0};      // buffered messages given up at the deadline
+    quint64 unwritten {0};      // handed to the Writer but not written at the deadline
+    quint64 spilled {0};        // left in the spill file for the next run
+    bool synced {false};        // the log file was written and fsynced
+    qint64 elapsedMs {0};
+};
+
+// Buffers, evicts and flushes the received messages to the Writer and the display.
+// The buffer is shared fairly between the modules: flushes take their messages
+// round robin per module, and a full buffer evicts from the module with the
+// largest backlog first, so a flooding module delays and loses its own messages.
+// Optionally a MessageCoalescer folds runs of repeated messages into one
+// "repeated N times" entry before they take up room in the buffer.
+// With the spill file enabled nothing is evicted: past maxSize messages go to a
+// SpillQueue on disk and are replayed in order as the buffer drains. A spill
+// file left behind by a crash is picked up by the next startNewLogFile().
+// The Logger lives on its own thread: the receivers publish into the lock-free
+// message ring and wake it up, flushed batches fan out to the sinks (the
+// Writer, the display and whatever is added with addSink()), and every ingested
+// batch is forwarded once more through messagesIngested() for the per-module
+// handling in the Controller. None of it waits for the GUI thread or another
+// sink, so a busy UI does not hold up logging.
+// A full Writer queue with the Block policy only holds back the Writer's share:
+// the other sinks keep getting every flush while the Writer's messages wait in
+// a backlog of up to maxSize messages, posted ahead of the next batch once the
+// Writer has room. A full backlog is handled like the full buffer: with flow
+// control or the spill file the Logger holds its messages back (and the buffer
+// pauses the receivers or spills), otherwise the backlog evicts its oldest
+// messages by severity.
+// Apart from flowControl(), stats() and displaySink() all members have to be called
+// on the Logger's thread (queued from elsewhere).
 class Logger : public QObject {
     Q_OBJECT
 public:
     explicit Logger(QObject *parent = nullptr);
     ~Logger();
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+    Logger(Logger&&) = delete;
+    Logger& operator=(Logger&&) = delete;
+
     void addMessage(const EventMessage &msg);
     bool isEmpty() const;
-    void startNewLogFile();
-    void logManualStop(uint32_t moduleId);
-    void setLoggerMaxSize(int const maxSize);
-    void setLoggerFlushInterval(int const flushInterval);
-    int getLoggerFlushInterval() const;
-    int getLoggerMaxSize();
-    void applyFlushInterval();
-    void applyFlushIntervalAfterAppStopped();
 
-signals:
-    void messageReady(const EventMessage &msg);
+    // Flow control: instead of evicting, pause the receivers at maxSize queued
+    // messages and resume them once the queue drained to half of that
+    std::shared_ptr<FlowControl> flowControl() const;
+    // Accepted/folded/evicted/rejected counters and the buffer depth, readable from any thread
+    std::shared_ptr<LoggerStats> stats() const;
+    // Bounded to s_displayCapacity messages, dropping the oldest, and decimated by the settings
+    std::shared_ptr<SinkQueue> displaySink() const;
+
+    void addSink(std::shared_ptr<LogSink> sink);
+    void removeSink(const std::shared_ptr<LogSink> &sink);
 
 public slots:
+    void applySettings(const LoggerSettings &settings);
+    void startNewLogFile();
+    void logManualStop(uint32_t moduleId);
     void flushBuffer();
 
+    // Hands everything buffered (and spilled) to the sinks in bulk, waits for the
+    // Writer and fsyncs the log file, giving up the rest once deadlineMs passed.
+    // Reports through flushedAfterStop(); the display renders the tail on its own.
+    void drainForShutdown(const int deadlineMs);
+
+    // Consumer side of the receivers' ring. The ring is handed over before the
+    // receivers start publishing, a previous ring is drained first.
+    void setMessageRing(std::shared_ptr<EventMessageRing> ring);
+    void drainMessageRing();
+
+    // Messages the receivers emitted directly instead of publishing them
+    void ingestMessages(const EventMessageBatch &batch);
+
+signals:
+    void messagesIngested(const EventMessageBatch &batch);
+    void displayReady();
+    void readingResumed();
+    void flushedAfterStop(const DrainReport &report);
+
 private:
     void clear();
+    void updateFlowControl();
+    void scheduleFlush(const int delay);
+    void bufferMessage(const EventMessage &msg, const qint64 now);
+    void takeSummaries(const qint64 now, const bool flushAll);
+    bool evictFor(const EventMessage &msg, const uint32_t victim);
+    bool spill(const EventMessage &msg);
+    void refillFromSpill();
+    bool postWriterBacklog(const bool force);
+    bool holdsBackForWriter() const;
+    void holdForWriter(const EventMessageBatch &batch);
+    void configureWriter();
+    void updateWriterStats();
+    void logClientShares() const;
 
 private:
-    std::deque<EventMessage> m_buffer;
+    MessageQueue m_buffer;
+    SpillQueue m_spill;
+    MessageCoalescer m_coalescer;
     QTimer m_flushTimer;
+    QElapsedTimer m_clock;
+    FlushScheduler m_scheduler;
     QString m_logFilePath;
     std::unique_ptr<Writer> m_logWriter;
-    int m_maxSize;
-    int m_flushInterval;
+    EventMessageBatch m_writerBacklog;  // flushed to the other sinks, refused by the Writer's full queue
+    std::shared_ptr<LogCompressor> m_compressor;
+    LoggerSettings m_settings;
+    std::shared_ptr<FlowControl> m_flowControl;
+    std::shared_ptr<LoggerStats> m_stats;
+    std::shared_ptr<SinkQueue> m_displaySink;
+    std::vector<std::shared_ptr<LogSink>> m_sinks;
+    std::shared_ptr<EventMessageRing> m_messageRing;
 };
 
 #endif // LOGGER_H
@@ -0,0 +1,136 @@
+#include "loggerstats.h"
+#include <algorithm>
+#include <chrono>
+
+LoggerStats::Counters LoggerStats::Snapshot::total() const
+{
+    Counters sum;
+    for (const Counters &counters : bySeverity)
+    {
+        sum.accepted += counters.accepted;
+        sum.folded += counters.folded;
+        sum.evicted += counters.evicted;
+        sum.rejected += counters.rejected;
+    }
+    return sum;
+}
+
+LoggerStats::~LoggerStats()
+{
+    for (std::atomic<Page *> &page : m_pages)
+        delete page.load(std::memory_order_relaxed);
+}
+
+void LoggerStats::countAccepted(const EventMessage &msg)
+{
+    increment(m_bySeverity[static_cast<size_t>(msg.severity)].accepted);
+    increment(module(msg.clientId).accepted);
+}
+
+void LoggerStats::countFolded(const EventMessage &msg)
+{
+    increment(m_bySeverity[static_cast<size_t>(msg.severity)].folded);
+    increment(module(msg.clientId).folded);
+}
+
+void LoggerStats::countEvicted(const uint32_t clientId, const Severity severity)
+{
+    increment(m_bySeverity[static_cast<size_t>(severity)].evicted);
+    increment(module(clientId).evicted);
+}
+
+void LoggerStats::countRejected(const EventMessage &msg)
+{
+    increment(m_bySeverity[static_cast<size_t>(msg.severity)].rejected);
+    increment(module(msg.clientId).rejected);
+}
+
+void LoggerStats::setDepth(const size_t depth)
+{
+    m_depth.store(depth, std::memory_order_relaxed);
+    if (depth > m_highWater.load(std::memory_order_relaxed))
+        m_highWater.store(depth, std::memory_order_relaxed);
+}
+
+void LoggerStats::setWriterQueue(const SinkQueue::Stats &stats)
+{
+    m_writerQueued.store(stats.queued, std::memory_order_relaxed);
+    m_writerQueuedBytes.store(stats.queuedBytes, std::memory_order_relaxed);
+    m_writerCapacityBytes.store(stats.capacityBytes, std::memory_order_relaxed);
+    m_writerHighWaterBytes.store(stats.highWaterBytes, std::memory_order_relaxed);
+    m_writerSpilled.store(stats.spilled, std::memory_order_relaxed);
+    m_writerDropped.store(stats.dropped, std::memory_order_relaxed);
+    m_writerBlockedNs.store(stats.blockedNs, std::memory_order_relaxed);
+    m_writerBlockedSinceNs.store(stats.blockedSinceNs, std::memory_order_relaxed);
+}
+
+LoggerStats::Snapshot LoggerStats::snapshot() const
+{
+    Snapshot snapshot;
+    for (int severity = 0; severity < SeverityCount; ++severity)
+        snapshot.bySeverity[severity] = load(m_bySeverity[severity]);
+
+    for (uint32_t pageIndex = 0; pageIndex < PageCount; ++pageIndex)
+    {
+        const Page *page = m_pages[pageIndex].load(std::memory_order_acquire);
+        if (!page)
+            continue;
+        for (uint32_t i = 0; i < PageSize; ++i)
+        {
+            const Counters counters = load((*page)[i]);
+            if (counters.accepted == 0 && counters.folded == 0 && counters.evicted == 0 && counters.rejected == 0)
+                continue;
+            snapshot.byModule.push_back({pageIndex * PageSize + i, counters});
+        }
+    }
+    snapshot.depth = m_depth.load(std::memory_order_relaxed);
+    snapshot.highWater = m_highWater.load(std::memory_order_relaxed);
+
+    SinkQueue::Stats &writer = snapshot.writerQueue;
+    writer.queued = m_writerQueued.load(std::memory_order_relaxed);
+    writer.queuedBytes = m_writerQueuedBytes.load(std::memory_order_relaxed);
+    writer.capacityBytes = m_writerCapacityBytes.load(std::memory_order_relaxed);
+    writer.highWaterBytes = m_writerHighWaterBytes.load(std::memory_order_relaxed);
+    writer.spilled = m_writerSpilled.load(std::memory_order_relaxed);
+    writer.dropped = m_writerDropped.load(std::memory_order_relaxed);
+    writer.blockedNs = m_writerBlockedNs.load(std::memory_order_relaxed);
+    writer.blockedSinceNs = m_writerBlockedSinceNs.load(std::memory_order_relaxed);
+    // the Logger does not update while it is blocked, the running period is added here
+    if (writer.blockedSinceNs != 0)
+    {
+        using namespace std::chrono;
+        const qint64 now = duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+        writer.blockedNs += std::max<qint64>(0, now - writer.blockedSinceNs);
+    }
+    return snapshot;
+}
+
+// Single writer: a plain load and store is enough and avoids the locked add
+void LoggerStats::increment(std::atomic<quint64> &counter)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+LoggerStats::Counters LoggerStats::load(const AtomicCounters &counters)
+{
+    Counters values;
+    values.accepted = counters.accepted.load(std::memory_order_relaxed);
+    values.folded = counters.folded.load(std::memory_order_relaxed);
+    values.evicted = counters.evicted.load(std::memory_order_relaxed);
+    values.rejected = counters.rejected.load(std::memory_order_relaxed);
+    return values;
+}
+
+// Ids beyond MaxModuleId only come from broken senders, they share the slot of id 0
+LoggerStats::AtomicCounters &LoggerStats::module(const uint32_t clientId)
+{
+    const uint32_t id = clientId <= ModuleRegistry::MaxModuleId ? clientId : 0;
+    std::atomic<Page *> &slot = m_pages[id / PageSize];
+    Page *page = slot.load(std::memory_order_relaxed);
+    if (!page)
+    {
+        page = new Page();
+        slot.store(page, std::memory_order_release);
+    }
+    return (*page)[id % PageSize];
+}
@@ -0,0 +1,104 @@
+#ifndef LOGGERSTATS_H
+#define LOGGERSTATS_H
+
+#include <QtGlobal>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "eventmessage.h"
+#include "moduleregistry.h"
+#include "sinkqueue.h"
+
+// Message accounting of the Logger, by severity and by module, plus the
+// buffer depth and its high-water mark.
+//
+// Only the Logger's thread writes, so every counter is a relaxed load and
+// store without a locked instruction; any thread may take a snapshot() at the
+// same time. Per-module counters live in pages of PageSize modules, allocated
+// the first time one of their modules counts something, so the table costs
+// nothing for ids that never show up.
+//
+// accepted: entered the Logger. folded: accepted, but only counted in a
+// "repeated N times" entry. evicted: accepted and dropped from the buffer later
+// (also at the shutdown deadline). rejected: never buffered. Every accepted
+// message that was neither folded nor evicted reached the sinks or is still
+// buffered.
+//
+// The Logger also copies the state of the Writer's queue in after every flush:
+// its depth, drops and spilled messages, and how long the Logger was blocked
+// on it, so a slow disk can be told apart from a slow pipeline.
+class LoggerStats
+{
+public:
+    struct Counters {
+        quint64 accepted {0};
+        quint64 folded {0};
+        quint64 evicted {0};
+        quint64 rejected {0};
+    };
+
+    struct ModuleCounters {
+        uint32_t clientId {0};
+        Counters counters;
+    };
+
+    struct Snapshot {
+        std::array<Counters, SeverityCount> bySeverity {};
+        std::vector<ModuleCounters> byModule;   // modules that counted anything, by id
+        quint64 depth {0};
+        quint64 highWater {0};
+        SinkQueue::Stats writerQueue;   // blockedNs includes a blocked period still running
+
+        Counters total() const;
+    };
+
+    LoggerStats() = default;
+    ~LoggerStats();
+
+    LoggerStats(const LoggerStats&) = delete;
+    LoggerStats& operator=(const LoggerStats&) = delete;
+
+    // Logger thread
+    void countAccepted(const EventMessage &msg);
+    void countFolded(const EventMessage &msg);
+    void countEvicted(const uint32_t clientId, const Severity severity);
+    void countRejected(const EventMessage &msg);
+    void setDepth(const size_t depth);
+    void setWriterQueue(const SinkQueue::Stats &stats);
+
+    // Any thread
+    Snapshot snapshot() const;
+
+private:
+    static constexpr uint32_t PageSize {256};
+    static constexpr uint32_t PageCount {(ModuleRegistry::MaxModuleId + PageSize) / PageSize};
+
+    struct AtomicCounters {
+        std::atomic<quint64> accepted {0};
+        std::atomic<quint64> folded {0};
+        std::atomic<quint64> evicted {0};
+        std::atomic<quint64> rejected {0};
+    };
+    using Page = std::array<AtomicCounters, PageSize>;
+
+    static void increment(std::atomic<quint64> &counter);
+    static Counters load(const AtomicCounters &counters);
+    AtomicCounters &module(const uint32_t clientId);
+
+private:
+    std::array<AtomicCounters, SeverityCount> m_bySeverity;
+    std::array<std::atomic<Page *>, PageCount> m_pages {};
+    std::atomic<quint64> m_depth {0};
+    std::atomic<quint64> m_highWater {0};
+    std::atomic<qsizetype> m_writerQueued {0};
+    std::atomic<qsizetype> m_writerQueuedBytes {0};
+    std::atomic<qsizetype> m_writerCapacityBytes {0};
+    std::atomic<qsizetype> m_writerHighWaterBytes {0};
+    std::atomic<quint64> m_writerSpilled {0};
+    std::atomic<quint64> m_writerDropped {0};
+    std::atomic<qint64> m_writerBlockedNs {0};
+    std::atomic<qint64> m_writerBlockedSinceNs {0};
+};
+
+#endif // LOGGERSTATS_H
@@ -0,0 +1,34 @@
+#ifndef LOGSINK_H
+#define LOGSINK_H
+
+#include <QtGlobal>
+#include "eventmessage.h"
+
+enum class SinkDropPolicy : uint8_t {
+    DropOldest,     // a full queue makes room for the new messages
+    DropNewest,     // a full queue rejects the new messages
+    DropBySeverity, // a full queue drops DATA first and CRITICAL last, oldest first
+    Block,          // nothing is dropped, the producer holds back while the queue is full
+    Spill           // past the capacity messages go to the sink's spill file
+};
+
+struct SinkPolicy {
+    qsizetype capacity {0};         // pending messages, 0 = unbounded
+    qsizetype capacityBytes {0};    // memory of the pending messages, 0 = unbounded
+    SinkDropPolicy dropPolicy {SinkDropPolicy::DropOldest};
+    int dataDecimation {1};         // forward every n-th DATA message of a module
+};
+
+// Receives every batch the Logger flushes (file Writer, display, ...). post()
+// is called on the Logger's thread and must not wait for the consumer: every
+// sink drains its own queue at its own rate and applies its own policy when it
+// falls behind, so a slow sink never holds up the Logger or the other sinks.
+class LogSink
+{
+public:
+    virtual ~LogSink() = default;
+
+    virtual void post(const EventMessageBatch &batch) = 0;
+};
+
+#endif // LOGSINK_H
@@ -0,0 +1,185 @@
+#include "logstream.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+// A batch is written once it is formatted, or whenever this much piled up
+constexpr qsizetype s_writeChunk {512 * 1024};
+
+bool syncHandle(const int handle)
+{
+#ifdef Q_OS_WIN
+    return _commit(handle) == 0;
+#else
+    return ::fsync(handle) == 0;
+#endif
+}
+}
+
+QString LogStream::newSegmentPath(const QString &directory, const QString &stream, const QString &extension)
+{
+    const QDir dir(directory);
+    QString base = "logger_" + QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss");
+    if (!stream.isEmpty())
+        base += "_" + stream;
+    QString path = dir.filePath(base + extension);
+    // segments rotated within the same second, compressed ones count as taken
+    for (int n = 1; QFile::exists(path) || QFile::exists(path + ".qz"); ++n) {
+        path = dir.filePath(QString("%1_%2%3").arg(base).arg(n).arg(extension));
+    }
+    return path;
+}
+
+bool LogStream::syncFile(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    return syncHandle(file.handle());
+}
+
+LogStream::LogStream(const QString &path, const QString &stream, const bool binary,
+                     std::shared_ptr<LogCompressor> compressor)
+    : m_path(path),
+    m_stream(stream),
+    m_binary(binary),
+    m_compressor(std::move(compressor))
+{
+    m_sinceSync.start();
+}
+
+LogStream::~LogStream()
+{
+    syncAndClose(false);
+}
+
+QString LogStream::path() const
+{
+    return m_path;
+}
+
+void LogStream::write(const EventMessageBatch &batch, const Policy &policy)
+{
+    if (m_file.isOpen() && rotationDue(policy))
+        rotate();
+    if (!openFile())
+        return;
+
+    if (m_binary) {
+        if (!m_binaryWriter.append(batch))
+            qWarning() << "Cannot write log file" << m_path << m_file.errorString();
+        if (policy.syncInterval == 0)
+            flush();
+        m_segmentBytes = m_binaryWriter.size();
+    } else {
+        for (const EventMessage &msg : batch) {
+            m_formatter.append(m_buffer, msg);
+            if (m_buffer.size() >= s_writeChunk)
+                writeBuffer();
+        }
+        writeBuffer();
+    }
+
+    if (policy.syncInterval == 0 || (policy.syncInterval > 0 && m_sinceSync.hasExpired(policy.syncInterval))) {
+        syncHandle(m_file.handle());
+        m_sinceSync.restart();
+    }
+}
+
+bool LogStream::hasBufferedData() const
+{
+    return m_binaryWriter.hasOpenBlock();
+}
+
+void LogStream::flush(const bool expiredOnly)
+{
+    if (!m_binaryWriter.hasOpenBlock() || (expiredOnly && !m_binaryWriter.openBlockExpired()))
+        return;
+    if (!m_binaryWriter.flush())
+        qWarning() << "Cannot write log file" << m_path << m_file.errorString();
+    m_segmentBytes = m_binaryWriter.size();
+}
+
+void LogStream::close(const Policy &policy)
+{
+    if (!m_file.isOpen())
+        return;
+    syncAndClose(policy.syncInterval >= 0);
+    if (m_compressor)
+        m_compressor->segmentClosed(m_path);
+}
+
+// Opens the segment on the first write and keeps it open; retried on every write after a failure
+bool LogStream::openFile()
+{
+    if (m_file.isOpen())
+        return true;
+
+    // before the file exists, so a scan of the compressor never takes it for a closed one
+    if (m_compressor)
+        m_compressor->segmentOpened(m_path);
+    m_file.setFileName(m_path);
+    // Unbuffered: the batch buffer already is the write buffer, QFile would only copy it once more
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Unbuffered)) {
+        if (!m_openFailed)
+            qWarning() << "Cannot open log file" << m_path << m_file.errorString();
+        m_openFailed = true;
+        return false;
+    }
+    m_openFailed = false;
+    m_segmentBytes = m_file.size();
+    m_segmentAge.start();
+    if (!m_binary)
+        m_buffer.reserve(s_writeChunk);
+    if (m_binary && !m_binaryWriter.begin(&m_file))
+        qWarning() << "Cannot write log file" << m_path << m_file.errorString();
+    return true;
+}
+
+bool LogStream::rotationDue(const Policy &policy) const
+{
+    return (policy.rotateBytes > 0 && m_segmentBytes >= policy.rotateBytes)
+        || (policy.rotateAgeMs > 0 && m_segmentAge.hasExpired(policy.rotateAgeMs));
+}
+
+// Closes the active segment and switches to a new one, which openFile() opens
+// right after. Compressing the closed segment is left to the LogCompressor.
+void LogStream::rotate()
+{
+    const QString closed = m_path;
+    // closed segments are always on disk, a later sync only covers the active one
+    syncAndClose(true);
+    m_path = newSegmentPath(QFileInfo(closed).path(), m_stream, "." + QFileInfo(closed).suffix());
+    qDebug() << "Rotated log file" << closed << "after" << m_segmentBytes << "bytes, continuing in" << m_path;
+    if (m_compressor)
+        m_compressor->segmentClosed(closed);
+}
+
+void LogStream::syncAndClose(const bool sync)
+{
+    if (!m_file.isOpen())
+        return;
+    if (m_binaryWriter.isActive() && !m_binaryWriter.finish())
+        qWarning() << "Cannot write the index of" << m_path << m_file.errorString();
+    if (sync)
+        syncHandle(m_file.handle());
+    m_file.close();
+}
+
+void LogStream::writeBuffer()
+{
+    if (m_buffer.isEmpty())
+        return;
+    if (m_file.write(m_buffer) != m_buffer.size())
+        qWarning() << "Cannot write log file" << m_path << m_file.errorString();
+    m_segmentBytes += m_buffer.size();
+    m_buffer.resize(0);     // keeps the capacity
+}
@@ -0,0 +1,81 @@
+#ifndef LOGSTREAM_H
+#define LOGSTREAM_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QString>
+#include <memory>
+#include "binarylog.h"
+#include "eventmessage.h"
+#include "logcompressor.h"
+#include "logformatter.h"
+
+// One output stream of the Writer: the log file of all modules, of one module
+// or of a group of modules, in the text or the binary format.
+// The file is opened on the first write and stays open; a batch is formatted
+// into a reused buffer and written in one go (in chunks of a few hundred KiB
+// for very large batches). Past the rotation size or age the segment is closed
+// before the next write and a new one in the same format is started next to
+// it; the closed one goes to the LogCompressor.
+// In the binary format the records of small batches collect in an open block
+// (see BinaryLogWriter) that the Writer has written with flush() when the
+// stream is idle or a sync() asks for it; with a sync after every write the
+// block is written with each batch.
+// A stream is used by one thread at a time: the Writer hands each stream at
+// most one batch at a time, so the messages of a stream stay in order whichever
+// pool thread writes them.
+class LogStream
+{
+public:
+    struct Policy {
+        int syncInterval {-1};      // ms between fsyncs, -1 = never, 0 = after every write
+        qint64 rotateBytes {0};     // 0 = no limit
+        qint64 rotateAgeMs {0};     // 0 = no limit
+    };
+
+    // A new logger_<timestamp>[_<stream>]<extension> in directory that does not exist yet
+    static QString newSegmentPath(const QString &directory, const QString &stream, const QString &extension);
+    // fsyncs a file by path, for segments the caller does not hold open
+    static bool syncFile(const QString &path);
+
+    // The first segment is path, rotated ones are named after stream
+    LogStream(const QString &path, const QString &stream, const bool binary,
+              std::shared_ptr<LogCompressor> compressor);
+    ~LogStream();
+
+    LogStream(const LogStream&) = delete;
+    LogStream& operator=(const LogStream&) = delete;
+
+    QString path() const;
+    void write(const EventMessageBatch &batch, const Policy &policy);
+    // Messages written to the stream but not to the file yet
+    bool hasBufferedData() const;
+    // Writes them; with expiredOnly only a binary block that is old enough
+    void flush(const bool expiredOnly = false);
+    // Closes the active segment, fsynced unless the policy never syncs, and hands it to the compressor
+    void close(const Policy &policy);
+
+private:
+    bool openFile();
+    void writeBuffer();
+    bool rotationDue(const Policy &policy) const;
+    void rotate();
+    void syncAndClose(const bool force);
+
+private:
+    QString m_path;
+    const QString m_stream;
+    const bool m_binary;
+    const std::shared_ptr<LogCompressor> m_compressor;
+    QFile m_file;
+    QByteArray m_buffer;
+    LogFormatter m_formatter;
+    BinaryLogWriter m_binaryWriter;
+    qint64 m_segmentBytes {0};
+    QElapsedTimer m_segmentAge;
+    QElapsedTimer m_sinceSync;
+    bool m_openFailed {false};
+};
+
+#endif // LOGSTREAM_H
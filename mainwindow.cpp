@@ -2,14 +2,12 @@
 #include <QCoreApplication>
 #include <QMessageBox>
 #include <QRegularExpression>
+#include <QStatusBar>
 #include <QDebug>
 
 #include "settings.h"
 #include "ui_mainwindow.h"
 
-constexpr uint32_t s_numberOfModules = 3U;
-static std::array<bool, s_numberOfModules> s_errorNotified { false, false, false };
-static std::array<bool, s_numberOfModules> s_moduleStopped { false, false, false };
 constexpr uint32_t s_criticalModule = 3U;
 
 MainWindow::MainWindow(QWidget *parent)
@@ -47,14 +45,6 @@ MainWindow::MainWindow(QWidget *parent)
     m_glPlot = new OpenGL3DPlot(ui->page3DPlot);
     ui->page3DPlot->layout()->addWidget(m_glPlot);
 
-    m_graphModule1 = m_customPlot->addGraph();
-    m_graphModule2 = m_customPlot->addGraph();
-    m_graphModule3 = m_customPlot->addGraph();
-
-    m_graphModule1->setPen(QPen(Qt::red));
-    m_graphModule2->setPen(QPen(Qt::green));
-    m_graphModule3->setPen(QPen(Qt::blue));
-
     m_customPlot->xAxis->setLabel("Time (s)");
     m_customPlot->yAxis->setLabel("Value");
 
@@ -71,16 +61,25 @@ MainWindow::MainWindow(QWidget *parent)
     connect(m_plot3DUpdateTimer, &QTimer::timeout, this, &MainWindow::updatePlot3D);
     m_plot3DUpdateTimer->start();
 
+    // Logger accounting in the status bar, the breakdown per severity and module in its tooltip
+    m_statsLabel = new QLabel(this);
+    statusBar()->addPermanentWidget(m_statsLabel);
+    m_statsTimer = new QTimer(this);
+    m_statsTimer->setInterval(1000);
+    connect(m_statsTimer, &QTimer::timeout, this, &MainWindow::updateLoggerStats);
+    m_statsTimer->start();
+    updateLoggerStats();
+
     ui->logTextEdit->setReadOnly(true);
     ui->startModulesButton->setEnabled(true);
     ui->stopApplicationButton->setEnabled(false);
-    ui->stopModule1Button->setEnabled(false);
-    ui->stopModule2Button->setEnabled(false);
-    ui->stopModule3Button->setEnabled(false);
+    ui->stopSelectedModulesButton->setEnabled(false);
 
+    connect(ui->moduleListWidget, &QListWidget::itemSelectionChanged, this, &MainWindow::updateStopSelectedButton);
+    connect(m_controller.get(), &Controller::moduleRegistered, this, &MainWindow::addModule);
     connect(m_controller.get(), &Controller::modulesStarted, this, &MainWindow::modulesStarted);
     connect(m_controller.get(), &Controller::newMessage, this, &MainWindow::handleMessage, Qt::QueuedConnection);
-    connect(m_controller.get(), &Controller::displayMessage, this, &MainWindow::displayMessage);
+    connect(m_controller.get(), &Controller::displayMessages, this, &MainWindow::displayMessages);
     connect(ui->actionSettings, &QAction::triggered, this, &MainWindow::onOpenSettings);
     connect(m_controller.get(), &Controller::moduleStopped, this, &MainWindow::stopModule);
     connect(m_controller.get(), &Controller::systemMessage, this, &MainWindow::appendSystemMessage);
@@ -119,46 +118,37 @@ void MainWindow::handleMessage(const uint32_t clientId, const Controller::Messag
     m_watchdogTimer->start();
 
     if (msgType == Controller::MessageType::CRITICAL) {
-        ui->stopModule1Button->setEnabled(false);
-        ui->stopModule2Button->setEnabled(false);
-        ui->stopModule3Button->setEnabled(false);
         ui->stopApplicationButton->setEnabled(false);
-        s_moduleStopped = {true, true, true};
+        setAllModulesStopped();
     } else if (msgType ==  Controller::MessageType::ERROR) {
-        switch (clientId){
-        case 1: {
-            if (!s_moduleStopped[0]) {
-                ui->stopModule1Button->setEnabled(true);
-            }
-            break;
+        const int index = m_controller->moduleIndex(clientId);
+        if (index == ModuleRegistry::InvalidIndex) {
+            return;
         }
-        case 2: {
-            if (!s_moduleStopped[1]) {
-                ui->stopModule2Button->setEnabled(true);
-            }
-            break;
-        }
-        case 3: {
-            if (!s_moduleStopped[2]) {
-                ui->stopModule3Button->setEnabled(true);
-                if (!s_moduleStopped[0]) {
-                    ui->stopModule1Button->setEnabled(true);
-                }
-                if (!s_moduleStopped[1]) {
-                    ui->stopModule2Button->setEnabled(true);
+
+        if (!m_modules[index].stopped && !m_modules[index].stoppable) {
+            m_modules[index].stoppable = true;
+            refreshModuleItem(index);
+            // an error of the critical module unlocks the manual stop of every running module
+            if (clientId == s_criticalModule) {
+                for (int i = 0; i < int(m_modules.size()); ++i) {
+                    if (!m_modules[i].stopped && !m_modules[i].stoppable) {
+                        m_modules[i].stoppable = true;
+                        refreshModuleItem(i);
+                    }
                 }
             }
-            break;
+            updateStopSelectedButton();
         }
-        default:
-            break;
-        }
-        if (!s_errorNotified[clientId - 1]) {            
+
+        if (!m_modules[index].errorNotified) {
             if (clientId == s_criticalModule) {
-                s_errorNotified = {true, true, true};
+                for (ModuleView &module : m_modules) {
+                    module.errorNotified = true;
+                }
             }
             else {
-               s_errorNotified[clientId - 1] = true;     
+               m_modules[index].errorNotified = true;
             }
             QMetaObject::invokeMethod(this, [this, clientId]() {
                 QMessageBox::information(this, "Error Received", QString("An error occurred for module %1. You may now stop the logger manually.\n" ).arg(clientId));
@@ -167,56 +157,67 @@ void MainWindow::handleMessage(const uint32_t clientId, const Controller::Messag
     }
 }
 
-void MainWindow::displayMessage(const EventMessage &msg) {
-    QMetaObject::invokeMethod(this, [this, msg]() {
-        qDebug() << "DISPLAY:" << msg.clientId << msg.type << msg.text;
+void MainWindow::displayMessages(const EventMessageBatch &batch) {
+    QMetaObject::invokeMethod(this, [this, batch]() {
         m_watchdogTimer->start();
         QTextCursor cursor = ui->logTextEdit->textCursor();
         cursor.movePosition(QTextCursor::End);
 
-        QTextCharFormat format;
-        if ((msg.clientId == 1 && s_moduleStopped[0]) ||
-            (msg.clientId == 2 && s_moduleStopped[1]) ||
-            (msg.clientId == 3 && s_moduleStopped[2]))
-        {
-            if (msg.type != "CRITICAL") {
-                format.setForeground(Qt::gray);
-                cursor.insertText(QString("[%1] Message from client%2 %3: %4 (%5)\n").
-                                  arg(msg.timestamp.toString(), QString::number(msg.clientId), msg.type, msg.text, "message was already in the logger queue, the communication has already stopped"), format);
-            }
-            else {
-                // most of the time the CRITICAL message for each module from flushing the buffer
-                // will come after the s_moduleStopped[X] was flagged so the coloring of the message
-                // should be always the same for better visibility reasons
-                format.setForeground(Qt::magenta);
-                format.setFontWeight(QFont::Bold);
-                cursor.insertText(QString("[%1] Message from client%2 %3: %4\n").
-                                  arg(msg.timestamp.toString(), QString::number(msg.clientId), msg.type, msg.text), format);
-            }
+        // one edit block per flushed batch, so the text edit lays out once
+        cursor.beginEditBlock();
+        for (const EventMessage &msg : batch) {
+            appendMessage(cursor, msg);
         }
-        else
-        {
-            if (msg.type == "INFO") {
-                format.setForeground(Qt::darkGreen);
-            } else if (msg.type == "WARNING") {
-                format.setForeground(Qt::darkYellow);
-            } else if (msg.type == "ERROR") {
-                format.setForeground(Qt::red);
-            } else if (msg.type == "CRITICAL") {
-                format.setForeground(Qt::magenta);
-                format.setFontWeight(QFont::Bold);
-            }
-            cursor.insertText(QString("[%1] Message from client%2 %3: %4\n").
-                              arg(msg.timestamp.toString(), QString::number(msg.clientId), msg.type, msg.text), format);
-        }
-        ui->logTextEdit->setTextCursor(cursor);
+        QTextCharFormat format;
         format.setForeground(Qt::black);
         format.setFontWeight(QFont::Normal);
         cursor.insertText(QString(""), format);
+        cursor.endEditBlock();
         ui->logTextEdit->setTextCursor(cursor);
     }, Qt::QueuedConnection);
 }
 
+void MainWindow::appendMessage(QTextCursor &cursor, const EventMessage &msg) {
+    const QString type = severityName(msg.severity);
+    const QString text = msg.text.toString();
+    qDebug() << "DISPLAY:" << msg.clientId << type << text;
+
+    QTextCharFormat format;
+    const int index = m_controller->moduleIndex(msg.clientId);
+    if (index != ModuleRegistry::InvalidIndex && m_modules[index].stopped)
+    {
+        if (msg.severity != Severity::Critical) {
+            format.setForeground(Qt::gray);
+            cursor.insertText(QString("[%1] Message from client%2 %3: %4 (%5)\n").
+                              arg(timestampToDateTime(msg.timestamp).toString(), QString::number(msg.clientId), type, text, "message was already in the logger queue, the communication has already stopped"), format);
+        }
+        else {
+            // most of the time the CRITICAL message for each module from flushing the buffer
+            // will come after the module was flagged as stopped so the coloring of the message
+            // should be always the same for better visibility reasons
+            format.setForeground(Qt::magenta);
+            format.setFontWeight(QFont::Bold);
+            cursor.insertText(QString("[%1] Message from client%2 %3: %4\n").
+                              arg(timestampToDateTime(msg.timestamp).toString(), QString::number(msg.clientId), type, text), format);
+        }
+    }
+    else
+    {
+        if (msg.severity == Severity::Info) {
+            format.setForeground(Qt::darkGreen);
+        } else if (msg.severity == Severity::Warning) {
+            format.setForeground(Qt::darkYellow);
+        } else if (msg.severity == Severity::Error) {
+            format.setForeground(Qt::red);
+        } else if (msg.severity == Severity::Critical) {
+            format.setForeground(Qt::magenta);
+            format.setFontWeight(QFont::Bold);
+        }
+        cursor.insertText(QString("[%1] Message from client%2 %3: %4\n").
+                          arg(timestampToDateTime(msg.timestamp).toString(), QString::number(msg.clientId), type, text), format);
+    }
+}
+
 void MainWindow::handleWatchdogTimeout()
 {
     appendSystemMessage("No message received in the last 10 seconds.\n");
@@ -226,8 +227,13 @@ void MainWindow::modulesStarted()
 {
     ui->startModulesButton->setEnabled(false);
     ui->stopApplicationButton->setEnabled(true);
-    s_errorNotified = {false, false, false};
-    s_moduleStopped = {false, false, false};
+    for (int i = 0; i < int(m_modules.size()); ++i) {
+        m_modules[i].stopped = false;
+        m_modules[i].stoppable = false;
+        m_modules[i].errorNotified = false;
+        refreshModuleItem(i);
+    }
+    updateStopSelectedButton();
     m_watchdogTimer->start();
     ui->actionSettings->setEnabled(false);
 }
@@ -254,21 +260,16 @@ void MainWindow::on_stopApplicationButton_clicked()
         // this code should never reached!
         qDebug() << "tried to stop the application after the modules are stopped";
         ui->stopApplicationButton->setEnabled(false);
-        ui->stopModule1Button->setEnabled(false);
-        ui->stopModule2Button->setEnabled(false);
-        ui->stopModule3Button->setEnabled(false);
+        setAllModulesStopped();
         ui->startModulesButton->setEnabled(true);
         ui->actionSettings->setEnabled(true);
         return;
     }
 
-    ui->stopModule1Button->setEnabled(false);
-    ui->stopModule2Button->setEnabled(false);
-    ui->stopModule3Button->setEnabled(false);
     ui->stopApplicationButton->setEnabled(false);
     ui->startModulesButton->setEnabled(true);
     ui->actionSettings->setEnabled(true);
-    s_moduleStopped = {true, true, true};
+    setAllModulesStopped();
 }
 
 
@@ -278,67 +279,139 @@ void MainWindow::on_clearButton_clicked()
 }
 
 
-void MainWindow::on_stopModule1Button_clicked()
+void MainWindow::on_stopSelectedModulesButton_clicked()
 {
-    m_controller->stopModule(1, true);
-}
+    // Collect first: stopping the last running module stops the application and updates every module
+    std::vector<uint32_t> clientIds;
+    for (const QListWidgetItem *item : ui->moduleListWidget->selectedItems()) {
+        const ModuleView &module = m_modules[item->data(Qt::UserRole).toInt()];
+        if (module.stoppable && !module.stopped) {
+            clientIds.push_back(module.clientId);
+        }
+    }
 
+    for (const uint32_t clientId : clientIds) {
+        m_controller->stopModule(clientId, true);
+    }
+}
 
-void MainWindow::on_stopModule2Button_clicked()
+void MainWindow::addModule(const int index, const uint32_t clientId)
 {
-    m_controller->stopModule(2, true);
+    if (index != int(m_modules.size())) {
+        qWarning() << "Module" << clientId << "registered out of order with index" << index;
+        return;
+    }
+
+    ModuleView module;
+    module.clientId = clientId;
+    module.graph = m_customPlot->addGraph();
+    module.graph->setPen(QPen(moduleColor(index)));
+    module.item = new QListWidgetItem(ui->moduleListWidget);
+    module.item->setData(Qt::UserRole, index);
+    m_modules.push_back(module);
+    m_glPlot->setModuleCount(index + 1);
+    refreshModuleItem(index);
 }
 
-void MainWindow::on_stopModule3Button_clicked()
+void MainWindow::refreshModuleItem(const int index)
 {
-    m_controller->stopModule(3, true);
+    const ModuleView &module = m_modules[index];
+    if (module.stopped) {
+        module.item->setText(QString("Module %1 (stopped)").arg(module.clientId));
+        module.item->setForeground(Qt::gray);
+    } else if (module.stoppable) {
+        module.item->setText(QString("Module %1 (error)").arg(module.clientId));
+        module.item->setForeground(Qt::red);
+    } else {
+        module.item->setText(QString("Module %1").arg(module.clientId));
+        module.item->setForeground(moduleColor(index));
+    }
 }
 
-void MainWindow::updatePlot2D()
+void MainWindow::setAllModulesStopped()
 {
-    QDateTime currentTime = QDateTime::currentDateTime();
-
-    QVector<QPointF> data1 = m_controller->getProcessedCurve2D(0, currentTime);
-    QVector<QPointF> data2 = m_controller->getProcessedCurve2D(1, currentTime);
-    QVector<QPointF> data3 = m_controller->getProcessedCurve2D(2, currentTime);
+    for (int i = 0; i < int(m_modules.size()); ++i) {
+        m_modules[i].stopped = true;
+        m_modules[i].stoppable = false;
+        refreshModuleItem(i);
+    }
+    updateStopSelectedButton();
+}
 
-    m_graphModule1->setData(QVector<double>(), QVector<double>());
-    m_graphModule2->setData(QVector<double>(), QVector<double>());
-    m_graphModule3->setData(QVector<double>(), QVector<double>());
+void MainWindow::updateStopSelectedButton()
+{
+    bool enabled {false};
+    for (const QListWidgetItem *item : ui->moduleListWidget->selectedItems()) {
+        const ModuleView &module = m_modules[item->data(Qt::UserRole).toInt()];
+        if (module.stoppable && !module.stopped) {
+            enabled = true;
+            break;
+        }
+    }
+    ui->stopSelectedModulesButton->setEnabled(enabled);
+}
 
-    QVector<double> x1, y1, x2, y2, x3, y3;
+void MainWindow::updatePlot2D()
+{
+    const qint64 currentTime = currentTimestamp();
 
-    for (const auto &point : data1)
+    QVector<double> x, y;
+    for (int index = 0; index < int(m_modules.size()); ++index)
     {
-        x1.append(point.x());
-        y1.append(point.y());
-    }
-    for (const auto &point : data2)
-    {
-        x2.append(point.x());
-        y2.append(point.y());
-    }
-    for (const auto &point : data3)
-    {
-        x3.append(point.x());
-        y3.append(point.y());
+        const QVector<QPointF> data = m_controller->getProcessedCurve2D(index, currentTime);
+        x.resize(data.size());
+        y.resize(data.size());
+        for (qsizetype i = 0; i < data.size(); ++i)
+        {
+            x[i] = data[i].x();
+            y[i] = data[i].y();
+        }
+        m_modules[index].graph->setData(x, y, true);
     }
 
-    m_graphModule1->setData(x1, y1);
-    m_graphModule2->setData(x2, y2);
-    m_graphModule3->setData(x3, y3);
-
     double windowSec = m_controller->getPlotTimeWindow();
     m_customPlot->xAxis->setRange(-windowSec, 0);
     m_customPlot->yAxis->setRange(0,100);
     m_customPlot->replot();
 }
 
+void MainWindow::updateLoggerStats()
+{
+    const LoggerStats::Snapshot stats = m_controller->loggerStats();
+    const LoggerStats::Counters total = stats.total();
+    const SinkQueue::Stats &writer = stats.writerQueue;
+    const auto mebibytes = [](const qsizetype bytes) { return QString::number(double(bytes) / (1024.0 * 1024.0), 'f', 1); };
+    m_statsLabel->setText(QString("Buffer %1 (max %2) | accepted %3 | folded %4 | evicted %5 | rejected %6"
+                                  " | Writer queue %7/%8 MiB, blocked %9 s%10")
+                              .arg(stats.depth).arg(stats.highWater)
+                              .arg(total.accepted).arg(total.folded).arg(total.evicted).arg(total.rejected)
+                              .arg(mebibytes(writer.queuedBytes), mebibytes(writer.capacityBytes))
+                              .arg(double(writer.blockedNs) / 1e9, 0, 'f', 1)
+                              .arg(writer.blockedSinceNs != 0 ? QString(" (now)") : QString()));
+
+    const auto row = [](const QString &name, const LoggerStats::Counters &counters) {
+        return QString("<tr><td>%1</td><td align=right>%2</td><td align=right>%3</td><td align=right>%4</td><td align=right>%5</td></tr>")
+            .arg(name).arg(counters.accepted).arg(counters.folded).arg(counters.evicted).arg(counters.rejected);
+    };
+    QString table = "<table><tr><th></th><th>accepted</th><th>folded</th><th>evicted</th><th>rejected</th></tr>";
+    for (int severity = 0; severity < SeverityCount; ++severity) {
+        table += row(severityName(static_cast<Severity>(severity)), stats.bySeverity[severity]);
+    }
+    for (const LoggerStats::ModuleCounters &module : stats.byModule) {
+        table += row(QString("Module %1").arg(module.clientId), module.counters);
+    }
+    table += "</table>";
+    table += QString("<p>Writer queue: %1 messages, %2 MiB (peak %3 MiB), %4 spilled, %5 dropped</p>")
+                 .arg(writer.queued).arg(mebibytes(writer.queuedBytes), mebibytes(writer.highWaterBytes))
+                 .arg(writer.spilled).arg(writer.dropped);
+    m_statsLabel->setToolTip(table);
+}
+
 void MainWindow::updatePlot3D()
 {
-    QDateTime currentTime = QDateTime::currentDateTime();
+    const qint64 currentTime = currentTimestamp();
 
-    for (int moduleId = 0; moduleId < 3; ++moduleId) {
+    for (int moduleId = 0; moduleId < int(m_modules.size()); ++moduleId) {
         QVector<QVector3D> qvec = m_controller->getProcessedCurve3D(moduleId, currentTime);
         std::vector<QVector3D> stdvec(qvec.begin(), qvec.end());
         m_glPlot->setPoints(moduleId, stdvec);
@@ -347,26 +420,19 @@ void MainWindow::updatePlot3D()
 
 void MainWindow::stopModule(const int clientId, const bool logMessage, const bool stopApplication)
 {
-    s_moduleStopped[clientId -1] = true;
+    const int index = m_controller->moduleIndex(clientId);
+    if (index != ModuleRegistry::InvalidIndex) {
+        m_modules[index].stopped = true;
+        m_modules[index].stoppable = false;
+        refreshModuleItem(index);
+        updateStopSelectedButton();
+    }
     if(logMessage){
         appendSystemMessage(QString("Module %1 manually stopped via Stop Module %1 button.\n").arg(clientId));
     }
     else {
         appendSystemMessage(QString("CRITICAL message received from module %1. Module %1 auto-stopped.\n").arg(clientId));
     }
-    switch (clientId){
-    case 1:
-        ui->stopModule1Button->setEnabled(false);
-        break;
-    case 2:
-        ui->stopModule2Button->setEnabled(false);
-        break;
-    case 3:
-        ui->stopModule3Button->setEnabled(false);
-        break;
-    default:
-        break;
-    }
     if (stopApplication)
     {
         ui->stopApplicationButton->setEnabled(false);
@@ -5,7 +5,10 @@
 #include <QTimer>
 #include <QProcess>
 #include <QOpenGLWidget>
-#include "dataprocessor.h"
+#include <QListWidgetItem>
+#include <QLabel>
+#include <QTextCursor>
+#include <vector>
 #include "qcustomplot.h"
 #include "controller.h"
 #include "opengl3dplot.h"
@@ -28,14 +31,14 @@ public:
 private slots:
     void modulesStarted();
     void handleMessage(const uint32_t clientId, const Controller::MessageType msgType);
-    void displayMessage(const EventMessage &msg);
+    void displayMessages(const EventMessageBatch &batch);
     void handleWatchdogTimeout();
     void on_startModulesButton_clicked();
     void on_stopApplicationButton_clicked();
     void on_clearButton_clicked();
-    void on_stopModule1Button_clicked();
-    void on_stopModule2Button_clicked();
-    void on_stopModule3Button_clicked();
+    void on_stopSelectedModulesButton_clicked();
+    void addModule(const int index, const uint32_t clientId);
+    void updateStopSelectedButton();
     void onOpenSettings();
     void updatePlot2D();
     void updatePlot3D();
@@ -43,23 +46,34 @@ private slots:
     void appendSystemMessage(QString const & msg);
     void loggerFlushedAfterStop();
 
+    void updateLoggerStats();
+
     void on_rB2DPlot_toggled(bool checked);
 
     void on_rB3DPlot_toggled(bool checked);
 
 private:
+    void refreshModuleItem(const int index);
+    void setAllModulesStopped();
+    void appendMessage(QTextCursor &cursor, const EventMessage &msg);
+
+private:
+    // UI state of one module, addressed by the Controller's module index
+    struct ModuleView {
+        uint32_t clientId = 0;
+        QCPGraph *graph = nullptr;
+        QListWidgetItem *item = nullptr;
+        bool stopped = false;
+        bool stoppable = false;     // an ERROR unlocked the manual stop
+        bool errorNotified = false;
+    };
+
     Ui::MainWindow *ui;
     std::unique_ptr<Controller> m_controller;
-    // Processing incoming data from data points
-    DataProcessor m_processorModule1;
-    DataProcessor m_processorModule2;
-    DataProcessor m_processorModule3;
+    std::vector<ModuleView> m_modules;
 
     //2D Plot
     QCustomPlot *m_customPlot;
-    QCPGraph *m_graphModule1;
-    QCPGraph *m_graphModule2;
-    QCPGraph *m_graphModule3;
 
     // 3D Plot
     OpenGL3DPlot *m_glPlot = nullptr;
@@ -68,5 +82,7 @@ private:
     QTimer *m_watchdogTimer;
     QTimer *m_plot2DUpdateTimer;
     QTimer *m_plot3DUpdateTimer;
+    QTimer *m_statsTimer;
+    QLabel *m_statsLabel;
 };
 #endif // MAINWINDOW_H
@@ -8,7 +8,7 @@ import signal
 import sys
 
 """
-Simulates three modules sending status and sensor data over TCP.
+Simulates a number of modules (three by default) sending status and sensor data over TCP.
 
 Each module runs in its own thread and sends messages like INFO, WARNING, ERROR, or CRITICAL
 to a central server. Useful for testing and debugging the EventMonitor application.
@@ -30,6 +30,7 @@ MAX_MESSAGE_INTERVAL_SEC = 0.15
 parser = argparse.ArgumentParser(description="TCP message generator.")
 parser.add_argument("--ip", type=str, default="127.0.0.1", help="Target IP address")
 parser.add_argument("--port", type=int, default=1024, help="Target port")
+parser.add_argument("--modules", type=int, default=3, help="Number of simulated modules")
 args = parser.parse_args()
 
 # Define value ranges and weights
@@ -42,12 +43,12 @@ ranges = [
 weights = [r["weight"] for r in ranges]
 
 # State per client variables
-clients = [1, 2, 3]
+clients = list(range(1, max(1, args.modules) + 1))
 sockets = {}
-last_logged_range_per_client = {1: None, 2: None, 3: None}
-normal_counter = {1: 0, 2: 0, 3: 0}
-normal_values = {1: [], 2: [], 3: []}
-active_clients = {1: True, 2: True, 3: True}
+last_logged_range_per_client = {client_id: None for client_id in clients}
+normal_counter = {client_id: 0 for client_id in clients}
+normal_values = {client_id: [] for client_id in clients}
+active_clients = {client_id: True for client_id in clients}
 lock = threading.Lock()
 
 def connect_client(client_id):
@@ -0,0 +1,108 @@
+#include "messagecoalescer.h"
+#include <algorithm>
+
+void MessageCoalescer::configure(const qint64 windowUs, const bool templates)
+{
+    m_windowUs = std::max<qint64>(windowUs, 1);
+    m_templates = templates;
+}
+
+void MessageCoalescer::clear()
+{
+    m_windows.clear();
+    m_expiry.clear();
+    m_pendingRepeats = 0;
+}
+
+bool MessageCoalescer::admit(const EventMessage &msg, const qint64 now)
+{
+    if (msg.severity == Severity::Data)
+        return true;
+
+    // Callers run takeExpired() with the same now first, so every window left is open
+    const QByteArrayView text = matchedText(msg);
+    const quint64 key = qHashMulti(0, msg.clientId, static_cast<uint8_t>(msg.severity), text);
+    const auto it = m_windows.find(key);
+    if (it != m_windows.end())
+    {
+        // a different message with the same hash is not folded, the window stays its own
+        if (it->last.clientId != msg.clientId || it->last.severity != msg.severity || it->text != text)
+            return true;
+        if (it->repeats++ == 0)
+        {
+            it->firstRepeat = msg.timestamp;
+            ++m_pendingRepeats;
+        }
+        it->last = msg;
+        return false;
+    }
+
+    Window window;
+    window.openedAt = now;
+    window.text = text.toByteArray();
+    window.last = msg;
+    m_windows.insert(key, window);
+    m_expiry.push_back({key, now});
+    return true;
+}
+
+void MessageCoalescer::takeExpired(const qint64 now, EventMessageBatch &summaries, const bool flushAll)
+{
+    while (!m_expiry.empty())
+    {
+        const Expiry expiry = m_expiry.front();
+        if (!flushAll && now - expiry.openedAt < m_windowUs)
+            break;
+        m_expiry.pop_front();
+
+        const auto it = m_windows.find(expiry.key);
+        if (it == m_windows.end())
+            continue;
+        if (it->repeats > 0)
+        {
+            summaries.append(summary(*it));
+            --m_pendingRepeats;
+        }
+        m_windows.erase(it);
+    }
+}
+
+qint64 MessageCoalescer::nextSummaryIn(const qint64 now) const
+{
+    if (m_pendingRepeats == 0 || m_expiry.empty())
+        return -1;
+    return std::max<qint64>(m_expiry.front().openedAt + m_windowUs - now, 0);
+}
+
+QByteArrayView MessageCoalescer::matchedText(const EventMessage &msg)
+{
+    const QByteArrayView text = msg.text.utf8();
+    if (m_templates)
+    {
+        // every run of digits becomes one '#'
+        m_normalized.resize(0);
+        bool inNumber {false};
+        for (const char c : text)
+        {
+            const bool digit = c >= '0' && c <= '9';
+            if (!digit)
+                m_normalized.append(c);
+            else if (!inNumber)
+                m_normalized.append('#');
+            inNumber = digit;
+        }
+        return m_normalized;
+    }
+    return text;
+}
+
+EventMessage MessageCoalescer::summary(const Window &window)
+{
+    EventMessage msg = window.last;
+    msg.text = QString("%1 [repeated %2 times, first %3, last %4]")
+                   .arg(window.last.text.toString())
+                   .arg(window.repeats)
+                   .arg(timestampToDateTime(window.firstRepeat).toString("HH:mm:ss.zzz"),
+                        timestampToDateTime(window.last.timestamp).toString("HH:mm:ss.zzz"));
+    return msg;
+}
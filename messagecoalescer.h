@@ -0,0 +1,66 @@
+#ifndef MESSAGECOALESCER_H
+#define MESSAGECOALESCER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <deque>
+#include "eventmessage.h"
+
+// Folds runs of repeated messages into one summary entry before they reach
+// the Logger buffer.
+//
+// Messages are fingerprinted by client, severity and a hash of the text, or of
+// its template where every run of digits counts as one placeholder, so "Value
+// 3.2 entered WARNING range" and "Value 3.4 entered WARNING range" match. A
+// window keeps the (normalized) text and a hit on the hash only counts as a
+// repeat if it matches; a colliding message just passes. DATA messages always
+// pass: every sample is a value of its own, and under a template all of them
+// would look alike. The first message of a fingerprint passes and opens a
+// window; repeats within it are only counted. When the window is over the repeats leave as one message,
+// "<last text> [repeated N times, first .., last ..]" with the timestamp of the
+// last repeat. Windows expire in the order they were opened, so takeExpired()
+// only looks at the front of a FIFO.
+class MessageCoalescer
+{
+public:
+    void configure(const qint64 windowUs, const bool templates);
+    void clear();
+
+    // now is a monotonic time in µs, takeExpired(now) has to run first.
+    // False if msg was folded into an open window.
+    bool admit(const EventMessage &msg, const qint64 now);
+
+    // Summaries of the windows over at now, all of them with flushAll
+    void takeExpired(const qint64 now, EventMessageBatch &summaries, const bool flushAll = false);
+
+    // µs until the next summary is due, -1 if no window holds repeats
+    qint64 nextSummaryIn(const qint64 now) const;
+
+private:
+    struct Window {
+        qint64 openedAt {0};
+        QByteArray text;        // what the fingerprint hashed
+        EventMessage last;
+        qint64 firstRepeat {0};
+        quint32 repeats {0};
+    };
+
+    struct Expiry {
+        quint64 key {0};
+        qint64 openedAt {0};
+    };
+
+    // The text as it is matched, valid until the next call
+    QByteArrayView matchedText(const EventMessage &msg);
+    static EventMessage summary(const Window &window);
+
+private:
+    QHash<quint64, Window> m_windows;
+    std::deque<Expiry> m_expiry;
+    QByteArray m_normalized;
+    qint64 m_windowUs {2000000};
+    bool m_templates {true};
+    qsizetype m_pendingRepeats {0};    // windows holding repeats
+};
+
+#endif // MESSAGECOALESCER_H
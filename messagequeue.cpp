@@ -0,0 +1,243 @@
+#include "messagequeue.h"
+#include <algorithm>
+#include <utility>
+
+bool MessageQueue::empty() const
+{
+    return m_size == 0;
+}
+
+size_t MessageQueue::size() const
+{
+    return m_size;
+}
+
+void MessageQueue::setQuantum(const int quantum)
+{
+    m_quantum = std::max(1, quantum);
+}
+
+void MessageQueue::setClientWeight(const uint32_t clientId, const int weight)
+{
+    // takes effect with the client's next turn
+    m_clients[clientSlot(clientId)].weight = std::max(1, weight);
+}
+
+void MessageQueue::push(const EventMessage &msg, const qint64 enqueuedAt)
+{
+    const uint32_t slot = clientSlot(msg.clientId);
+    const uint32_t index = allocateNode();
+    ClientQueue &client = m_clients[slot];
+    Node &node = m_nodes[index];
+    node.msg = msg;
+    node.sequence = m_nextSequence++;
+    node.enqueuedAt = enqueuedAt;
+    node.prev = client.tail;
+    node.next = Npos;
+    node.nextSame = Npos;
+
+    if (client.tail != Npos)
+        m_nodes[client.tail].next = index;
+    else
+        client.head = index;
+    client.tail = index;
+
+    const size_t severity = static_cast<size_t>(msg.severity);
+    if (client.severityTail[severity] != Npos)
+        m_nodes[client.severityTail[severity]].nextSame = index;
+    else
+        client.severityHead[severity] = index;
+    client.severityTail[severity] = index;
+
+    if (++client.size == 1)
+        activate(slot);
+    if (m_heaviest == Npos || client.size > m_clients[m_heaviest].size)
+        m_heaviest = slot;
+    ++m_size;
+}
+
+EventMessage MessageQueue::takeNext(qint64 *enqueuedAt)
+{
+    const uint32_t slot = m_activeHead;
+    ClientQueue &client = m_clients[slot];
+    const uint32_t index = client.head;
+    if (enqueuedAt)
+        *enqueuedAt = m_nodes[index].enqueuedAt;
+    EventMessage msg = std::move(m_nodes[index].msg);
+    ++client.flushed;
+    remove(slot, index);
+
+    // remove() took an emptied client off the active list, otherwise its turn
+    // ends once the deficit is used up
+    if (client.size > 0 && --client.deficit <= 0)
+    {
+        client.deficit = client.weight * m_quantum;
+        unlinkActive(slot);
+        linkActive(slot);
+    }
+    return msg;
+}
+
+bool MessageQueue::evictOldest(const uint32_t clientId, std::initializer_list<Severity> severities, Severity *evicted)
+{
+    const auto it = m_slotByClient.find(clientId);
+    if (it == m_slotByClient.end())
+        return false;
+
+    const uint32_t slot = it->second;
+    const ClientQueue &client = m_clients[slot];
+    uint32_t oldest {Npos};
+    for (const Severity severity : severities)
+    {
+        const uint32_t head = client.severityHead[static_cast<size_t>(severity)];
+        if (head != Npos && (oldest == Npos || m_nodes[head].sequence < m_nodes[oldest].sequence))
+            oldest = head;
+    }
+    if (oldest == Npos)
+        return false;
+
+    if (evicted)
+        *evicted = m_nodes[oldest].msg.severity;
+    ++m_clients[slot].evicted;
+    remove(slot, oldest);
+    return true;
+}
+
+uint32_t MessageQueue::heaviestClient() const
+{
+    if (m_heaviest != Npos && m_clients[m_heaviest].size > 0)
+        return m_clients[m_heaviest].clientId;
+    if (m_activeHead != Npos)
+        return m_clients[m_activeHead].clientId;
+    return 0;
+}
+
+std::vector<MessageQueue::ClientShare> MessageQueue::clientShares() const
+{
+    std::vector<ClientShare> shares;
+    shares.reserve(m_clients.size());
+    for (const ClientQueue &client : m_clients)
+        shares.push_back({client.clientId, client.size, client.flushed, client.evicted});
+    return shares;
+}
+
+void MessageQueue::discardAll(const std::function<void(const EventMessage &)> &onDiscard)
+{
+    for (uint32_t slot = 0; slot < m_clients.size(); ++slot)
+    {
+        m_clients[slot].evicted += m_clients[slot].size;
+        while (m_clients[slot].head != Npos)
+        {
+            if (onDiscard)
+                onDiscard(m_nodes[m_clients[slot].head].msg);
+            remove(slot, m_clients[slot].head);
+        }
+    }
+}
+
+void MessageQueue::clear()
+{
+    m_nodes.clear();
+    m_freeHead = Npos;
+    m_clients.clear();
+    m_slotByClient.clear();
+    m_activeHead = Npos;
+    m_activeTail = Npos;
+    m_heaviest = Npos;
+    m_size = 0;
+}
+
+uint32_t MessageQueue::clientSlot(const uint32_t clientId)
+{
+    const auto [it, inserted] = m_slotByClient.try_emplace(clientId, static_cast<uint32_t>(m_clients.size()));
+    if (inserted)
+    {
+        ClientQueue client;
+        client.clientId = clientId;
+        m_clients.push_back(client);
+    }
+    return it->second;
+}
+
+uint32_t MessageQueue::allocateNode()
+{
+    if (m_freeHead != Npos)
+    {
+        const uint32_t index = m_freeHead;
+        m_freeHead = m_nodes[index].next;
+        return index;
+    }
+    m_nodes.emplace_back();
+    return static_cast<uint32_t>(m_nodes.size() - 1);
+}
+
+// A client joins the end of the round with a fresh deficit
+void MessageQueue::activate(const uint32_t slot)
+{
+    ClientQueue &client = m_clients[slot];
+    client.deficit = client.weight * m_quantum;
+    linkActive(slot);
+}
+
+void MessageQueue::linkActive(const uint32_t slot)
+{
+    ClientQueue &client = m_clients[slot];
+    client.prevActive = m_activeTail;
+    client.nextActive = Npos;
+    if (m_activeTail != Npos)
+        m_clients[m_activeTail].nextActive = slot;
+    else
+        m_activeHead = slot;
+    m_activeTail = slot;
+}
+
+void MessageQueue::unlinkActive(const uint32_t slot)
+{
+    ClientQueue &client = m_clients[slot];
+    if (client.prevActive != Npos)
+        m_clients[client.prevActive].nextActive = client.nextActive;
+    else
+        m_activeHead = client.nextActive;
+    if (client.nextActive != Npos)
+        m_clients[client.nextActive].prevActive = client.prevActive;
+    else
+        m_activeTail = client.prevActive;
+    client.prevActive = Npos;
+    client.nextActive = Npos;
+}
+
+// index is always the head of its severity list: the client list and every
+// severity list are in arrival order, and only the oldest of a severity is removed
+void MessageQueue::remove(const uint32_t slot, const uint32_t index)
+{
+    ClientQueue &client = m_clients[slot];
+    Node &node = m_nodes[index];
+
+    if (node.prev != Npos)
+        m_nodes[node.prev].next = node.next;
+    else
+        client.head = node.next;
+    if (node.next != Npos)
+        m_nodes[node.next].prev = node.prev;
+    else
+        client.tail = node.prev;
+
+    const size_t severity = static_cast<size_t>(node.msg.severity);
+    client.severityHead[severity] = node.nextSame;
+    if (node.nextSame == Npos)
+        client.severityTail[severity] = Npos;
+    --m_size;
+
+    node.msg.text = MessageText();
+    node.prev = Npos;
+    node.nextSame = Npos;
+    node.next = m_freeHead;
+    m_freeHead = index;
+
+    // An emptied client leaves the round, eviction may empty one anywhere in it
+    if (--client.size == 0)
+    {
+        client.deficit = 0;
+        unlinkActive(slot);
+    }
+}
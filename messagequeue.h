@@ -0,0 +1,111 @@
+#ifndef MESSAGEQUEUE_H
+#define MESSAGEQUEUE_H
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <unordered_map>
+#include <vector>
+#include "eventmessage.h"
+
+// The Logger's buffered messages, queued per client and handed out by deficit
+// round robin, so a module flooding the Logger only delays itself.
+//
+// All messages live in one node pool. Every client has its own intrusive FIFO
+// in arrival order plus one FIFO per severity; the oldest message of a severity
+// is always the head of that list, so "drop the oldest DATA of this client" is
+// a look at a few list heads plus an unlink. Clients with queued messages form
+// the active list: the client at its head hands out up to weight * quantum
+// messages, then moves to the tail. Enqueue, dequeue and eviction are O(1)
+// independent of the queue length and the number of clients.
+class MessageQueue
+{
+public:
+    // Per client counters, flushed is the client's share of the output
+    struct ClientShare {
+        uint32_t clientId {0};
+        size_t queued {0};
+        quint64 flushed {0};
+        quint64 evicted {0};
+    };
+
+    MessageQueue() = default;
+
+    bool empty() const;
+    size_t size() const;
+
+    // Messages a client of weight 1 may hand out per round
+    void setQuantum(const int quantum);
+    // Relative share of clientId, 1 unless set
+    void setClientWeight(const uint32_t clientId, const int weight);
+
+    // enqueuedAt is an arbitrary monotonic time stamp, handed back by takeNext()
+    void push(const EventMessage &msg, const qint64 enqueuedAt = 0);
+
+    // Removes and returns the next message in round robin order. The queue must not be empty.
+    EventMessage takeNext(qint64 *enqueuedAt = nullptr);
+
+    // Drops the oldest message of clientId whose severity is one of severities, false if there is none.
+    // evicted receives the severity of the dropped message.
+    bool evictOldest(const uint32_t clientId, std::initializer_list<Severity> severities, Severity *evicted = nullptr);
+
+    // Client with the most queued messages. Tracked incrementally, so after
+    // dequeues it may trail the true maximum by a few messages.
+    uint32_t heaviestClient() const;
+
+    std::vector<ClientShare> clientShares() const;
+
+    // Drops every queued message, counted as evicted, and passes each one to onDiscard.
+    // Weights and counters stay.
+    void discardAll(const std::function<void(const EventMessage &)> &onDiscard = {});
+    void clear();
+
+private:
+    static constexpr uint32_t Npos {UINT32_MAX};
+
+    struct Node {
+        EventMessage msg;
+        quint64 sequence {0};
+        qint64 enqueuedAt {0};
+        uint32_t prev {Npos};       // arrival order within the client
+        uint32_t next {Npos};       // arrival order within the client, or the free list
+        uint32_t nextSame {Npos};   // next message of the same client and severity
+    };
+
+    struct ClientQueue {
+        uint32_t clientId {0};
+        uint32_t head {Npos};
+        uint32_t tail {Npos};
+        std::array<uint32_t, SeverityCount> severityHead {Npos, Npos, Npos, Npos, Npos};
+        std::array<uint32_t, SeverityCount> severityTail {Npos, Npos, Npos, Npos, Npos};
+        size_t size {0};
+        int weight {1};
+        int deficit {0};
+        uint32_t prevActive {Npos};
+        uint32_t nextActive {Npos};
+        quint64 flushed {0};
+        quint64 evicted {0};
+    };
+
+    uint32_t clientSlot(const uint32_t clientId);
+    uint32_t allocateNode();
+    void remove(const uint32_t slot, const uint32_t index);
+    void activate(const uint32_t slot);
+    void linkActive(const uint32_t slot);
+    void unlinkActive(const uint32_t slot);
+
+private:
+    std::vector<Node> m_nodes;
+    uint32_t m_freeHead {Npos};
+    std::vector<ClientQueue> m_clients;
+    std::unordered_map<uint32_t, uint32_t> m_slotByClient;
+    uint32_t m_activeHead {Npos};
+    uint32_t m_activeTail {Npos};
+    uint32_t m_heaviest {Npos};
+    int m_quantum {8};
+    size_t m_size {0};
+    quint64 m_nextSequence {0};
+};
+
+#endif // MESSAGEQUEUE_H
@@ -0,0 +1,145 @@
+#ifndef MESSAGERING_H
+#define MESSAGERING_H
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "eventmessage.h"
+
+// Bounded lock-free ring buffer between the receiver thread(s) and one consumer.
+// Each slot carries a sequence number (Vyukov style), so producers and the
+// consumer only ever touch the slot they own and the two position counters.
+// With a single producer the enqueue position is advanced with a plain store,
+// with several producers (sharded receivers) it is claimed with a CAS.
+//
+// Besides the data the ring carries a "wakeup pending" flag so that producers
+// only post one notification to the consumer per batch, not one per message:
+// a producer calls requestWakeup() after pushing and only notifies when it
+// returns true, the consumer calls acknowledgeWakeup() right before draining.
+template<typename T>
+class BoundedRing
+{
+public:
+    enum class ProducerMode {
+        Single,
+        Multi
+    };
+
+    explicit BoundedRing(const size_t capacity, const ProducerMode mode = ProducerMode::Single)
+        : m_cells{std::make_unique<Cell[]>(std::bit_ceil(std::max<size_t>(capacity, 2)))},
+        m_mask{std::bit_ceil(std::max<size_t>(capacity, 2)) - 1},
+        m_mode{mode}
+    {
+        for (size_t i = 0; i <= m_mask; ++i)
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    BoundedRing(const BoundedRing&) = delete;
+    BoundedRing& operator=(const BoundedRing&) = delete;
+
+    // Producer side. Returns false when the ring is full, value is left untouched then.
+    bool tryPush(T &&value)
+    {
+        size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        Cell *cell = nullptr;
+
+        if (m_mode == ProducerMode::Single)
+        {
+            cell = &m_cells[pos & m_mask];
+            if (cell->sequence.load(std::memory_order_acquire) != pos)
+                return false;
+            m_enqueuePos.store(pos + 1, std::memory_order_relaxed);
+        }
+        else
+        {
+            while (true)
+            {
+                cell = &m_cells[pos & m_mask];
+                const size_t seq = cell->sequence.load(std::memory_order_acquire);
+                const auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+                if (diff == 0)
+                {
+                    if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (diff < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = m_enqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        cell->value = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side, single consumer only.
+    bool tryPop(T &value)
+    {
+        const size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+        Cell &cell = m_cells[pos & m_mask];
+        const size_t seq = cell.sequence.load(std::memory_order_acquire);
+        if (static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1) < 0)
+            return false;
+
+        value = std::move(cell.value);
+        cell.value = T{};
+        cell.sequence.store(pos + m_mask + 1, std::memory_order_release);
+        m_dequeuePos.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // True when the caller is the one that has to wake the consumer
+    bool requestWakeup()
+    {
+        return !m_wakeupPending.exchange(true, std::memory_order_acq_rel);
+    }
+
+    void acknowledgeWakeup()
+    {
+        m_wakeupPending.exchange(false, std::memory_order_acq_rel);
+    }
+
+    size_t capacity() const
+    {
+        return m_mask + 1;
+    }
+
+    // Only a snapshot when producers are active
+    size_t sizeApprox() const
+    {
+        const size_t enqueued = m_enqueuePos.load(std::memory_order_relaxed);
+        const size_t dequeued = m_dequeuePos.load(std::memory_order_relaxed);
+        return enqueued >= dequeued ? enqueued - dequeued : 0;
+    }
+
+    ProducerMode producerMode() const
+    {
+        return m_mode;
+    }
+
+private:
+    struct alignas(64) Cell {
+        std::atomic<size_t> sequence {0};
+        T value {};
+    };
+
+    std::unique_ptr<Cell[]> m_cells;
+    const size_t m_mask;
+    const ProducerMode m_mode;
+    alignas(64) std::atomic<size_t> m_enqueuePos {0};
+    alignas(64) std::atomic<size_t> m_dequeuePos {0};
+    alignas(64) std::atomic<bool> m_wakeupPending {false};
+};
+
+using EventMessageRing = BoundedRing<EventMessage>;
+
+#endif // MESSAGERING_H
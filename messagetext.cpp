@@ -0,0 +1,135 @@
+#include "messagetext.h"
+#include <atomic>
+#include <cstring>
+#include <new>
+
+// Header of the heap storage, the text bytes follow directly behind it
+struct MessageText::HeapBlock
+{
+    std::atomic<int> refs {1};
+
+    char *data()
+    {
+        return reinterpret_cast<char *>(this + 1);
+    }
+};
+
+static_assert(sizeof(MessageText) == 48, "MessageText is meant to fill 48 bytes");
+
+MessageText::MessageText(const QString &text)
+{
+    assign(text.toUtf8());
+}
+
+MessageText::~MessageText()
+{
+    release();
+}
+
+MessageText::MessageText(const MessageText &other)
+    : m_size(other.m_size)
+{
+    std::memcpy(m_data, other.m_data, sizeof(m_data));
+    if (!isInline())
+        heapBlock()->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+MessageText& MessageText::operator=(const MessageText &other)
+{
+    if (this != &other)
+    {
+        MessageText copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+MessageText::MessageText(MessageText &&other) noexcept
+    : m_size(other.m_size)
+{
+    std::memcpy(m_data, other.m_data, sizeof(m_data));
+    other.m_size = 0;
+}
+
+MessageText& MessageText::operator=(MessageText &&other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        m_size = other.m_size;
+        std::memcpy(m_data, other.m_data, sizeof(m_data));
+        other.m_size = 0;
+    }
+    return *this;
+}
+
+MessageText MessageText::fromUtf8(QByteArrayView utf8)
+{
+    MessageText text;
+    text.assign(utf8);
+    return text;
+}
+
+QByteArrayView MessageText::utf8() const
+{
+    if (isInline())
+        return QByteArrayView(m_data, m_size);
+    return QByteArrayView(heapBlock()->data(), m_size);
+}
+
+qsizetype MessageText::size() const
+{
+    return m_size;
+}
+
+bool MessageText::isEmpty() const
+{
+    return m_size == 0;
+}
+
+QString MessageText::toString() const
+{
+    return QString::fromUtf8(utf8());
+}
+
+bool MessageText::isInline() const
+{
+    return m_size <= InlineCapacity;
+}
+
+MessageText::HeapBlock *MessageText::heapBlock() const
+{
+    HeapBlock *block {nullptr};
+    std::memcpy(&block, m_data, sizeof(block));
+    return block;
+}
+
+void MessageText::assign(QByteArrayView utf8)
+{
+    release();
+    m_size = static_cast<uint32_t>(utf8.size());
+    if (isInline())
+    {
+        if (m_size > 0)
+            std::memcpy(m_data, utf8.data(), m_size);
+        return;
+    }
+
+    HeapBlock *block = new (::operator new(sizeof(HeapBlock) + utf8.size())) HeapBlock;
+    std::memcpy(block->data(), utf8.data(), utf8.size());
+    std::memcpy(m_data, &block, sizeof(block));
+}
+
+void MessageText::release()
+{
+    if (!isInline())
+    {
+        HeapBlock *block = heapBlock();
+        if (block->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            block->~HeapBlock();
+            ::operator delete(block);
+        }
+    }
+    m_size = 0;
+}
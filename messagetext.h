@@ -0,0 +1,52 @@
+#ifndef MESSAGETEXT_H
+#define MESSAGETEXT_H
+
+#include <QByteArrayView>
+#include <QString>
+#include <cstdint>
+
+// UTF-8 text of an EventMessage. Up to InlineCapacity bytes are stored in the
+// object itself, which covers the DATA samples and nearly all status lines, so
+// the common message needs no allocation at all. Longer text goes into one
+// immutable, reference counted heap block that copies share, so queuing a
+// message never copies or re-encodes its text.
+class MessageText
+{
+public:
+    static constexpr qsizetype InlineCapacity {44};
+
+    MessageText() = default;
+    MessageText(const QString &text);
+    ~MessageText();
+
+    MessageText(const MessageText &other);
+    MessageText& operator=(const MessageText &other);
+    MessageText(MessageText &&other) noexcept;
+    MessageText& operator=(MessageText &&other) noexcept;
+
+    static MessageText fromUtf8(QByteArrayView utf8);
+
+    QByteArrayView utf8() const;
+    qsizetype size() const;
+    bool isEmpty() const;
+    QString toString() const;
+
+    friend bool operator==(const MessageText &lhs, const MessageText &rhs)
+    {
+        return lhs.utf8() == rhs.utf8();
+    }
+
+private:
+    struct HeapBlock;
+
+    bool isInline() const;
+    HeapBlock *heapBlock() const;
+    void assign(QByteArrayView utf8);
+    void release();
+
+private:
+    uint32_t m_size {0};
+    char m_data[InlineCapacity] {};   // the text itself, or the HeapBlock pointer
+};
+
+#endif // MESSAGETEXT_H
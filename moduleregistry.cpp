@@ -0,0 +1,59 @@
+#include "moduleregistry.h"
+#include <QColor>
+
+int ModuleRegistry::indexOf(const uint32_t clientId) const
+{
+    if (clientId >= m_indexById.size())
+        return InvalidIndex;
+    return m_indexById[clientId];
+}
+
+int ModuleRegistry::registerModule(const uint32_t clientId, bool *added)
+{
+    if (added)
+        *added = false;
+    if (!isValidModuleId(clientId))
+        return InvalidIndex;
+
+    if (clientId >= m_indexById.size())
+        m_indexById.resize(clientId + 1, InvalidIndex);
+
+    int32_t &index = m_indexById[clientId];
+    if (index == InvalidIndex)
+    {
+        index = static_cast<int32_t>(m_ids.size());
+        m_ids.push_back(clientId);
+        if (added)
+            *added = true;
+    }
+    return index;
+}
+
+uint32_t ModuleRegistry::moduleId(const int index) const
+{
+    if (index < 0 || index >= size())
+        return 0;
+    return m_ids[index];
+}
+
+int ModuleRegistry::size() const
+{
+    return static_cast<int>(m_ids.size());
+}
+
+QColor moduleColor(const int index)
+{
+    // The first three keep the colours the plots always had, the rest are spread
+    // around the hue circle by the golden angle so neighbours stay distinguishable
+    switch (index)
+    {
+    case 0:
+        return Qt::red;
+    case 1:
+        return Qt::green;
+    case 2:
+        return Qt::blue;
+    default:
+        return QColor::fromHsv((index * 137) % 360, 230, 210);
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef MODULEREGISTRY_H
+#define MODULEREGISTRY_H
+
+#include <cstdint>
+#include <vector>
+
+class QColor;
+
+// Maps the module ids sent by the clients to dense indices 0..size()-1 in the
+// order the modules first show up. Per-module state elsewhere is kept in plain
+// vectors addressed by that index; the id lookup is a direct table, so it costs
+// the same for three modules as for a few thousand.
+class ModuleRegistry
+{
+public:
+    // Highest module id a client may use, ids start at 1
+    static constexpr uint32_t MaxModuleId {65535U};
+    static constexpr int InvalidIndex {-1};
+
+    static constexpr bool isValidModuleId(const uint32_t clientId)
+    {
+        return clientId >= 1 && clientId <= MaxModuleId;
+    }
+
+    // Dense index of clientId, InvalidIndex if the module was never registered
+    int indexOf(const uint32_t clientId) const;
+
+    // Registers clientId if it is new. Returns its index, InvalidIndex for ids out of range.
+    int registerModule(const uint32_t clientId, bool *added = nullptr);
+
+    uint32_t moduleId(const int index) const;
+    int size() const;
+
+private:
+    std::vector<int32_t> m_indexById;   // grown up to the highest id seen
+    std::vector<uint32_t> m_ids;        // index -> module id
+};
+
+// Stable plot colour of the module with the given index
+QColor moduleColor(const int index);
+
+#endif // MODULEREGISTRY_H
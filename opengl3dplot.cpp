@@ -1,4 +1,5 @@
 #include "opengl3dplot.h"
+#include "moduleregistry.h"
 #include <QtMath>
 #ifdef _WIN32
 #include <windows.h>
@@ -7,24 +8,20 @@
 #include <QDebug>
 #include <QMouseEvent>
 #include <QWheelEvent>
+#include <algorithm>
 
 OpenGL3DPlot::OpenGL3DPlot(QWidget* parent)
     : QOpenGLWidget(parent)
 {
     setMinimumSize(200, 200);
     setMouseTracking(true);
-    for (auto& mod : m_modules)
-        mod.vbo.create();
 }
 
 OpenGL3DPlot::~OpenGL3DPlot()
 {
     makeCurrent();
-    for (auto& mod : m_modules)
-    {
-        mod.vbo.destroy();
-        mod.vao.destroy();
-    }
+    m_vbo.destroy();
+    m_vao.destroy();
 
     if (m_shader.isLinked())
     {
@@ -74,27 +71,23 @@ void OpenGL3DPlot::paintGL()
     view.translate(-50, -50, 0);            // Centering scene
     m_shader.setUniformValue("u_view", view);
     drawAxes();
-    for (int i = 0; i < 3; ++i)
-    {
-        auto& mod = m_modules[i];
-        if (mod.cpuBuffer.empty()) continue;
-
-        const int bytes = mod.activePointCount * sizeof(QVector3D);
-
-        mod.vao.bind();
-        mod.vbo.bind();
-        mod.vbo.write(0, mod.cpuBuffer.data(), bytes);
 
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(QVector3D), nullptr);
+    m_vao.bind();
+    m_vbo.bind();
+    uploadDirtyModules();
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(QVector3D), nullptr);
 
+    for (size_t i = 0; i < m_pointCounts.size(); ++i)
+    {
+        if (m_pointCounts[i] == 0)
+            continue;
         m_shader.setUniformValue("u_color", m_colors[i]);
-        glDrawArrays(GL_LINE_STRIP, 0, mod.activePointCount);
-
-        mod.vbo.release();
-        mod.vao.release();
+        glDrawArrays(GL_LINE_STRIP, GLint(i) * m_maxPointsPerModule, m_pointCounts[i]);
     }
 
+    m_vbo.release();
+    m_vao.release();
     m_shader.release();
 }
 
@@ -109,27 +102,64 @@ void OpenGL3DPlot::setPoints(int moduleId, const std::vector<QVector3D>& points)
         return;
     }
 
-    if (moduleId < 0 || moduleId >= 3)
+    if (moduleId < 0 || moduleId >= int(m_pointCounts.size()))
         return;
 
-    auto& mod = m_modules[moduleId];
-    int count = std::min(int(points.size()), m_maxPointsPerModule);
+    const int count = std::min(int(points.size()), m_maxPointsPerModule);
+    if (count == 0 && m_pointCounts[moduleId] == 0)
+        return;
 
-    mod.cpuBuffer.assign(points.end() - count, points.end());
-    mod.activePointCount = count;
+    std::copy(points.end() - count, points.end(), m_vertices.begin() + size_t(moduleId) * m_maxPointsPerModule);
+    m_pointCounts[moduleId] = count;
+    m_dirty[moduleId] = true;
 
     update(); // triggers paintGL
 }
 
-void OpenGL3DPlot::clear()
+void OpenGL3DPlot::setModuleCount(const int moduleCount)
 {
-    for (auto& mod : m_modules) {
-        mod.cpuBuffer.clear();
-        mod.activePointCount = 0;
+    const int previous = int(m_pointCounts.size());
+    if (moduleCount <= previous)
+        return;
+
+    m_vertices.resize(size_t(moduleCount) * m_maxPointsPerModule);
+    m_pointCounts.resize(moduleCount, 0);
+    m_dirty.resize(moduleCount, false);
+    for (int i = previous; i < moduleCount; ++i)
+    {
+        const QColor color = moduleColor(i);
+        m_colors.emplace_back(color.redF(), color.greenF(), color.blueF());
     }
+}
+
+void OpenGL3DPlot::clear()
+{
+    std::fill(m_pointCounts.begin(), m_pointCounts.end(), 0);
     update();
 }
 
+void OpenGL3DPlot::uploadDirtyModules()
+{
+    // Grow geometrically so adding modules one by one does not reallocate every frame
+    const int needed = int(m_vertices.size());
+    if (needed > m_gpuCapacity)
+    {
+        m_gpuCapacity = std::max(needed, m_gpuCapacity * 2);
+        m_vbo.allocate(m_gpuCapacity * int(sizeof(QVector3D)));
+        std::fill(m_dirty.begin(), m_dirty.end(), true);
+    }
+
+    for (size_t i = 0; i < m_dirty.size(); ++i)
+    {
+        if (!m_dirty[i])
+            continue;
+        const int first = int(i) * m_maxPointsPerModule;
+        m_vbo.write(first * int(sizeof(QVector3D)), m_vertices.data() + first,
+                    m_pointCounts[i] * int(sizeof(QVector3D)));
+        m_dirty[i] = false;
+    }
+}
+
 void OpenGL3DPlot::setupShaders()
 {
     if (!m_shader.addShaderFromSourceCode(QOpenGLShader::Vertex,
@@ -165,21 +195,19 @@ void OpenGL3DPlot::setupShaders()
 
 void OpenGL3DPlot::setupBuffers()
 {
-    for (auto& mod : m_modules)
-    {
-        mod.vao.create();
-        mod.vao.bind();
-
-        mod.vbo.create();
-        mod.vbo.bind();
-        mod.vbo.setUsagePattern(QOpenGLBuffer::DynamicDraw);
-        mod.vbo.allocate(m_maxPointsPerModule * sizeof(QVector3D));
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(QVector3D), nullptr);
-
-        mod.vbo.release();
-        mod.vao.release();
-    }
+    m_vao.create();
+    m_vao.bind();
+
+    m_vbo.create();
+    m_vbo.bind();
+    m_vbo.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+    m_gpuCapacity = 0;
+    uploadDirtyModules();
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(QVector3D), nullptr);
+
+    m_vbo.release();
+    m_vao.release();
 }
 
 void OpenGL3DPlot::drawAxes()
@@ -218,7 +246,14 @@ void OpenGL3DPlot::drawAxes()
 
 void OpenGL3DPlot::setMaxPoints(const int maxPoints)
 {
+    if (maxPoints == m_maxPointsPerModule)
+        return;
+
+    // The per-module slots move, start over with empty curves
     m_maxPointsPerModule = maxPoints;
+    m_vertices.assign(m_pointCounts.size() * size_t(maxPoints), QVector3D());
+    std::fill(m_pointCounts.begin(), m_pointCounts.end(), 0);
+    std::fill(m_dirty.begin(), m_dirty.end(), true);
 }
 
 void OpenGL3DPlot::mousePressEvent(QMouseEvent* e)
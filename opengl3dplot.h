@@ -8,7 +8,6 @@
 #include <QOpenGLVertexArrayObject>
 #include <QMatrix4x4>
 #include <QVector3D>
-#include <array>
 #include <vector>
 
 
@@ -20,6 +19,7 @@ public:
     ~OpenGL3DPlot();
 
     void clear();
+    void setModuleCount(const int moduleCount);
     void setPoints(int moduleId, const std::vector<QVector3D>& points);
 
     void setMaxPoints(const int maxPoints);
@@ -35,31 +35,28 @@ protected:
 private:
     void setupShaders();
     void setupBuffers();
+    void uploadDirtyModules();
 
     void drawAxes();
 
     QOpenGLShaderProgram m_shader;
     QMatrix4x4 m_projMatrix;
 
-    struct ModuleGLData {
-        QOpenGLVertexArrayObject vao;
-        QOpenGLBuffer vbo{ QOpenGLBuffer::VertexBuffer };
-        std::vector<QVector3D> cpuBuffer;
-        int activePointCount = 0;
-    };
-
     // Camera control
     float m_zoom = 1.0f;
     float m_cameraAngleX = 30.0f;
     float m_cameraAngleY = -45.0f;
     QPointF m_lastMousePos;
 
-    std::array<ModuleGLData, 3> m_modules;
-    std::array<QVector3D, 3> m_colors {
-        QVector3D(1.0f, 0.0f, 0.0f), // red
-        QVector3D(0.0f, 1.0f, 0.0f), // green
-        QVector3D(0.0f, 0.0f, 1.0f)  // blue
-    };
+    // All modules share one vertex buffer: module i owns the slots
+    // [i * m_maxPointsPerModule, (i + 1) * m_maxPointsPerModule)
+    QOpenGLVertexArrayObject m_vao;
+    QOpenGLBuffer m_vbo{ QOpenGLBuffer::VertexBuffer };
+    int m_gpuCapacity {0};                  // vertices allocated on the GPU
+    std::vector<QVector3D> m_vertices;
+    std::vector<int> m_pointCounts;
+    std::vector<uint8_t> m_dirty;
+    std::vector<QVector3D> m_colors;
 
     int m_maxPointsPerModule {10}; // 10 is just a random initial value
 };
@@ -29,7 +29,7 @@ PythonProcessManager::~PythonProcessManager()
     stop();
 }
 
-void PythonProcessManager::start(const QString & ipAddress, const int localPort)
+void PythonProcessManager::start(const QString & ipAddress, const int localPort, const int moduleCount)
 {
     if (isRunning())
         return;
@@ -37,7 +37,8 @@ void PythonProcessManager::start(const QString & ipAddress, const int localPort)
     const QString scriptPath = QCoreApplication::applicationDirPath() + s_scriptFileName;
     m_process->setProgram("python");
     QStringList arguments;
-    arguments << "--ip" << ipAddress << "--port" << QString::number(localPort);
+    arguments << "--ip" << ipAddress << "--port" << QString::number(localPort)
+              << "--modules" << QString::number(moduleCount);
     m_process->setArguments(QStringList{scriptPath} + arguments);
     m_process->start();
 }
@@ -12,7 +12,7 @@ public:
     explicit PythonProcessManager(QObject *parent = nullptr);
     ~PythonProcessManager();
 
-    void start(const QString & ipAddress, const int localPort);
+    void start(const QString & ipAddress, const int localPort, const int moduleCount);
     void stop();
     bool isRunning() const;
 
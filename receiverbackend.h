@@ -0,0 +1,44 @@
+#ifndef RECEIVERBACKEND_H
+#define RECEIVERBACKEND_H
+
+#include <QObject>
+#include <QHostAddress>
+#include <functional>
+#include <memory>
+#include "eventmessage.h"
+#include "messagering.h"
+#include "flowcontrol.h"
+
+// Interface the Controller talks to for TCP ingest. Implementations live on
+// their own thread; listen() and close() may be called from any thread.
+class ReceiverBackend : public QObject
+{
+    Q_OBJECT
+public:
+    using QObject::QObject;
+    ~ReceiverBackend() override = default;
+
+    virtual bool listen(const QHostAddress &address, const quint16 port) = 0;
+    virtual void close() = 0;
+    virtual bool isListening() const = 0;
+    virtual void stopClient(uint32_t clientId) = 0;
+
+    // Publish parsed messages into a lock-free ring instead of emitting messagesReceived().
+    // notifier runs on a receiver thread, at most once per batch, when the consumer
+    // has to be woken up. Takes effect on the next listen().
+    virtual void setMessageRing(std::shared_ptr<EventMessageRing> ring, std::function<void()> notifier) = 0;
+
+    // Number of I/O threads servicing the accepted sockets. Takes effect on the next listen().
+    virtual void setWorkerCount(const int workerCount) = 0;
+
+    // Optional read gate, see FlowControl. Takes effect on the next listen().
+    virtual void setFlowControl(std::shared_ptr<FlowControl> flowControl) = 0;
+
+    // Reads the sockets that were left alone while the gate was closed
+    virtual void resumeReading() = 0;
+
+signals:
+    void messagesReceived(const EventMessageBatch &batch);
+};
+
+#endif // RECEIVERBACKEND_H
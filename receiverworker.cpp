@@ -0,0 +1,259 @@
+#include "receiverworker.h"
+#include "threadutils.h"
+#include <QDebug>
+
+namespace {
+// Bound of QTcpSocket's own buffer under flow control. Once it is full Qt stops
+// reading the descriptor and the kernel buffer and TCP window fill up instead.
+constexpr qint64 s_flowControlReadBufferSize {64 * 1024};
+}
+
+ReceiverWorker::ReceiverWorker(QObject *parent)
+    : QObject(parent),
+    m_publisher{this}
+{
+    // A backed up ring counts as a closed gate as well, re-read once it drained
+    m_publisher.setOverflowDrainedHandler([this] {
+        QMetaObject::invokeMethod(this, &ReceiverWorker::resumeReading, Qt::QueuedConnection);
+    });
+}
+
+ReceiverWorker::~ReceiverWorker() = default;
+
+void ReceiverWorker::setMessageRing(std::shared_ptr<EventMessageRing> ring, std::function<void()> notifier)
+{
+    m_publisher.setRing(std::move(ring), std::move(notifier));
+}
+
+void ReceiverWorker::setFlowControl(std::shared_ptr<FlowControl> flowControl)
+{
+    m_flowControl = std::move(flowControl);
+}
+
+bool ReceiverWorker::readingPaused() const
+{
+    return m_flowControl && m_flowControl->isEnabled()
+           && (m_flowControl->isPaused() || m_publisher.hasOverflow());
+}
+
+void ReceiverWorker::resumeReading()
+{
+    // readyRead is not emitted again for data that is already buffered
+    const QList<QTcpSocket*> sockets = m_sockets.values();
+    for (QTcpSocket *socket : sockets)
+    {
+        if (readingPaused())
+            return;
+        if (m_sockets.contains(socket) && socket->bytesAvailable() > 0)
+            onReadyRead(QPointer<QTcpSocket>(socket));
+    }
+}
+
+void ReceiverWorker::reserveConnection()
+{
+    m_connectionCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+int ReceiverWorker::connectionCount() const
+{
+    return m_connectionCount.load(std::memory_order_relaxed);
+}
+
+void ReceiverWorker::adoptSocket(qintptr socketDescriptor)
+{
+    auto *socket = new QTcpSocket(this);
+    if (!socket->setSocketDescriptor(socketDescriptor))
+    {
+        qWarning() << "Could not adopt socket descriptor:" << socket->errorString();
+        m_connectionCount.fetch_sub(1, std::memory_order_relaxed);
+        socket->deleteLater();
+        return;
+    }
+
+    m_sockets.insert(socket);
+    if (m_flowControl && m_flowControl->isEnabled())
+        socket->setReadBufferSize(s_flowControlReadBufferSize);
+
+    connect(socket, &QTcpSocket::readyRead, this, [this]() {
+        // Leave the data where it is, resumeReading() picks it up later
+        if (readingPaused())
+            return;
+        QPointer<QTcpSocket> sock = qobject_cast<QTcpSocket*>(sender());
+        onReadyRead(sock);
+    });
+
+    connect(socket, &QTcpSocket::disconnected, this, [this]() {
+        QPointer<QTcpSocket> sock = qobject_cast<QTcpSocket*>(sender());
+        onDisconnected(sock);
+    });
+
+    // The address may be reused by a later socket, so forget it once it is gone
+    connect(socket, &QObject::destroyed, this, [this, socket]() {
+        m_closing.remove(socket);
+    });
+}
+
+void ReceiverWorker::onDisconnected(QPointer<QTcpSocket> socket)
+{
+    if (!socket)
+        return;
+
+    if (m_closing.contains(socket.data()))
+        return;
+
+    // Data parked by flow control is still owed to the Logger
+    if (socket->bytesAvailable() > 0)
+    {
+        onReadyRead(socket);
+        if (!socket || m_closing.contains(socket.data()))
+            return;
+    }
+
+    const int clientKey = m_clients.key(socket, -1);
+    if (clientKey != -1)
+    {
+        m_clients.remove(clientKey);
+    }
+    releaseSocket(socket.data());
+    socket->deleteLater();
+}
+
+void ReceiverWorker::stopClient(uint32_t clientId)
+{
+    invokeOnObjectThread(this, [this, clientId] {
+        closeSocketOnce(clientId);
+    });
+}
+
+void ReceiverWorker::closeAll()
+{
+    const QList<QTcpSocket*> sockets = m_sockets.values();
+    for (QTcpSocket *socket : sockets)
+        closeSocket(socket);
+
+    m_clients.clear();
+    m_framers.clear();
+
+    // Nothing may get lost on shutdown: what does not fit into the ring goes the signal way
+    const EventMessageBatch rest = m_publisher.takeOverflow();
+    if (!rest.isEmpty())
+        emit messagesReceived(rest);
+}
+
+void ReceiverWorker::closeSocketOnce(const uint32_t clientId)
+{
+    auto it = m_clients.find(clientId);
+    if (it == m_clients.end())
+        return;
+
+    closeSocket(it.value());
+}
+
+void ReceiverWorker::closeSocket(QTcpSocket *socket)
+{
+    try {
+        if (!socket)
+            return;
+
+        // One-shot guard
+        if (m_closing.contains(socket))
+            return;
+
+        m_closing.insert(socket);
+
+        // Keep the destroyed() hookup, it clears the guard again
+        disconnect(socket, &QTcpSocket::readyRead, this, nullptr);
+        disconnect(socket, &QTcpSocket::disconnected, this, nullptr);
+
+        socket->disconnectFromHost();
+        if (socket->state() != QAbstractSocket::UnconnectedState)
+            socket->close();
+
+        const int key = m_clients.key(socket, -1);
+        if (key != -1)
+            m_clients.remove(key);
+        releaseSocket(socket);
+
+        // Defer deletion on owning thread (idempotent)
+        socket->deleteLater();
+    }
+    catch (const std::exception &e) {
+        qDebug() << "Exception while closing the sockets message:" << e.what();
+    } catch (...) {
+        qDebug() << "Unknown error while closing the sockets.";
+    }
+}
+
+void ReceiverWorker::releaseSocket(QTcpSocket *socket)
+{
+    m_framers.erase(socket);
+    if (m_sockets.remove(socket))
+        m_connectionCount.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void ReceiverWorker::onReadyRead(QPointer<QTcpSocket> socket)
+{
+    if (!socket) {
+        qDebug() << "onReadyRead called but sender() was null!";
+        return;
+    }
+
+    EventMessageBatch batch;
+    try
+    {
+        LineFramer &framer = m_framers.try_emplace(socket.data()).first->second;
+        if (framer.readFrom(socket.data()) <= 0)
+            return;
+
+        QByteArrayView rawLine;
+        while (framer.nextLine(rawLine))
+        {
+            const QByteArrayView line = rawLine.trimmed();
+            if (line.isEmpty())
+                continue;
+
+            EventMessage msg;
+            const LineStatus status = m_decoder.decodeMessage(line, msg);
+            if (status == LineStatus::Invalid)
+            {
+                qWarning() << "Invalid JSON:" << m_decoder.errorString() << "Data:" << line;
+                continue;
+            }
+            if (status == LineStatus::Corrupted)
+            {
+                batch.append(std::move(msg));
+                continue;
+            }
+
+            m_clients[msg.clientId] = socket.data();
+
+            // if module 3 has a critical message stop the entire logger
+            if (msg.severity == Severity::Critical)
+            {
+                if (msg.clientId == 3)
+                {
+                    emit shutdownRequested();
+                }
+                // for the other 2 modules just stop the respective module
+                else
+                {
+                    stopClient(msg.clientId);
+                }
+            }
+            batch.append(std::move(msg));
+
+            // stopClient() may have closed this very socket and released its framer
+            if (m_closing.contains(socket.data()))
+                break;
+        }
+    }
+    catch (const std::exception &e) {
+        qDebug() << "Exception while handling CRITICAL message:" << e.what();
+    } catch (...) {
+        qDebug() << "Unknown error while handling CRITICAL message.";
+    }
+
+    // Everything parsed from this read crosses the thread boundary in one go
+    if (!batch.isEmpty() && !m_publisher.publish(batch))
+        emit messagesReceived(batch);
+}
@@ -0,0 +1,75 @@
+#ifndef RECEIVERWORKER_H
+#define RECEIVERWORKER_H
+
+#include <QObject>
+#include <QTcpSocket>
+#include <QHash>
+#include <QSet>
+#include <QPointer>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include "eventmessage.h"
+#include "eventdecoder.h"
+#include "lineframer.h"
+#include "messagering.h"
+#include "ringpublisher.h"
+#include "flowcontrol.h"
+
+// One I/O thread of the EventReceiver pool. The acceptor hands it raw socket
+// descriptors; from then on the worker owns the sockets, their framing buffers
+// and its own decoder, so workers never share state on the hot path.
+class ReceiverWorker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ReceiverWorker(QObject *parent = nullptr);
+    ~ReceiverWorker();
+
+    ReceiverWorker(const ReceiverWorker&) = delete;
+    ReceiverWorker& operator=(const ReceiverWorker&) = delete;
+    ReceiverWorker(ReceiverWorker&&) = delete;
+    ReceiverWorker& operator=(ReceiverWorker&&) = delete;
+
+    // Must be called before the worker is moved to its thread
+    void setMessageRing(std::shared_ptr<EventMessageRing> ring, std::function<void()> notifier);
+    void setFlowControl(std::shared_ptr<FlowControl> flowControl);
+
+    // Accounting used by the acceptor for least-connections balancing. The
+    // acceptor reserves a slot before queueing adoptSocket(), so the count is
+    // already correct while the descriptor is in flight.
+    void reserveConnection();
+    int connectionCount() const;
+
+    void stopClient(uint32_t clientId);
+
+public slots:
+    void adoptSocket(qintptr socketDescriptor);
+    void closeAll();
+    void resumeReading();
+
+signals:
+    void messagesReceived(const EventMessageBatch &batch);
+    void shutdownRequested();
+
+private:
+    bool readingPaused() const;
+    void onReadyRead(QPointer<QTcpSocket> socket);
+    void onDisconnected(QPointer<QTcpSocket> socket);
+    void closeSocketOnce(const uint32_t clientId);
+    void closeSocket(QTcpSocket *socket);
+    void releaseSocket(QTcpSocket *socket);
+
+private:
+    QSet<QTcpSocket*> m_sockets;
+    QHash<uint32_t, QTcpSocket*> m_clients;
+    std::unordered_map<QTcpSocket*, LineFramer> m_framers;
+    QSet<QTcpSocket*> m_closing;
+    EventMessageDecoder m_decoder;
+    std::atomic<int> m_connectionCount {0};
+    RingPublisher m_publisher;
+    std::shared_ptr<FlowControl> m_flowControl;
+};
+
+#endif // RECEIVERWORKER_H
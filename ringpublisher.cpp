@@ -0,0 +1,97 @@
+#include "ringpublisher.h"
+#include <QTimer>
+#include <iterator>
+
+namespace {
+constexpr int s_ringRetryIntervalMs {1};
+}
+
+RingPublisher::RingPublisher(QObject *owner)
+    : m_owner{owner}
+{
+}
+
+void RingPublisher::setRing(std::shared_ptr<EventMessageRing> ring, std::function<void()> notifier)
+{
+    m_ring = std::move(ring);
+    m_notifier = std::move(notifier);
+}
+
+bool RingPublisher::hasRing() const
+{
+    return m_ring != nullptr;
+}
+
+bool RingPublisher::publish(EventMessageBatch &batch)
+{
+    if (!m_ring)
+        return false;
+
+    qsizetype next {0};
+    // Older messages still waiting in the overflow have to go first
+    if (m_overflow.empty())
+    {
+        while (next < batch.size() && m_ring->tryPush(std::move(batch[next])))
+            ++next;
+    }
+    for (; next < batch.size(); ++next)
+        m_overflow.push_back(std::move(batch[next]));
+
+    wakeConsumer();
+    flushOverflow();
+    return true;
+}
+
+EventMessageBatch RingPublisher::takeOverflow()
+{
+    flushOverflow();
+    EventMessageBatch rest(std::make_move_iterator(m_overflow.begin()),
+                           std::make_move_iterator(m_overflow.end()));
+    m_overflow.clear();
+    return rest;
+}
+
+bool RingPublisher::hasOverflow() const
+{
+    return !m_overflow.empty();
+}
+
+void RingPublisher::setOverflowDrainedHandler(std::function<void()> handler)
+{
+    m_drainedHandler = std::move(handler);
+}
+
+void RingPublisher::flushOverflow()
+{
+    if (!m_ring || m_overflow.empty())
+        return;
+
+    bool pushed {false};
+    while (!m_overflow.empty() && m_ring->tryPush(std::move(m_overflow.front())))
+    {
+        m_overflow.pop_front();
+        pushed = true;
+    }
+    if (pushed)
+    {
+        wakeConsumer();
+        if (m_overflow.empty() && m_drainedHandler)
+            m_drainedHandler();
+    }
+
+    if (!m_overflow.empty() && !m_retryScheduled)
+    {
+        // The consumer is behind, try again shortly even if no new data arrives
+        m_retryScheduled = true;
+        QTimer::singleShot(s_ringRetryIntervalMs, m_owner, [this] {
+            m_retryScheduled = false;
+            flushOverflow();
+        });
+    }
+}
+
+void RingPublisher::wakeConsumer()
+{
+    if (m_notifier && m_ring->requestWakeup())
+        m_notifier();
+}
@@ -0,0 +1,50 @@
+#ifndef RINGPUBLISHER_H
+#define RINGPUBLISHER_H
+
+#include <QObject>
+#include <deque>
+#include <functional>
+#include <memory>
+#include "eventmessage.h"
+#include "messagering.h"
+
+// Producer side of the EventMessageRing shared by the receiver backends.
+// Messages that do not fit into the ring are kept in order in a local overflow
+// and retried on the next publish() or from a short timer on the owner's thread,
+// so a full ring never drops or reorders anything.
+class RingPublisher
+{
+public:
+    explicit RingPublisher(QObject *owner);
+
+    RingPublisher(const RingPublisher&) = delete;
+    RingPublisher& operator=(const RingPublisher&) = delete;
+
+    void setRing(std::shared_ptr<EventMessageRing> ring, std::function<void()> notifier);
+    bool hasRing() const;
+
+    // Returns false when no ring is attached and the caller has to deliver the batch itself
+    bool publish(EventMessageBatch &batch);
+
+    // Pushes what fits and hands the rest back, used when the producer goes away
+    EventMessageBatch takeOverflow();
+
+    bool hasOverflow() const;
+
+    // Called on the owner's thread once a non-empty overflow has been fully pushed
+    void setOverflowDrainedHandler(std::function<void()> handler);
+
+private:
+    void flushOverflow();
+    void wakeConsumer();
+
+private:
+    QObject *m_owner;
+    std::shared_ptr<EventMessageRing> m_ring;
+    std::function<void()> m_notifier;
+    std::function<void()> m_drainedHandler;
+    std::deque<EventMessage> m_overflow;
+    bool m_retryScheduled {false};
+};
+
+#endif // RINGPUBLISHER_H
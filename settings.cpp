@@ -1,5 +1,6 @@
 #include "settings.h"
 #include "ui_settings.h"
+#include <algorithm>
 
 Settings::Settings(QWidget *parent)
     : QDialog(parent)
@@ -60,6 +61,169 @@ int Settings::getRingBufferSize() const
     return ui->ringBufferSizeSpinBox->value();
 }
 
+int Settings::getReceiverThreadCount() const
+{
+    return ui->receiverThreadsSpinBox->value();
+}
+
+int Settings::getSimulatedModuleCount() const
+{
+    return ui->simulatedModulesSpinBox->value();
+}
+
+bool Settings::isFlowControlEnabled() const
+{
+    return ui->flowControlCheckBox->isChecked();
+}
+
+int Settings::getFlushBatchSize() const
+{
+    return ui->flushBatchSizeSpinBox->value();
+}
+
+int Settings::getFlushTimeBudget() const
+{
+    return ui->flushTimeBudgetSpinBox->value();
+}
+
+bool Settings::isAdaptiveFlushEnabled() const
+{
+    return ui->adaptiveFlushCheckBox->isChecked();
+}
+
+int Settings::getLatencyTarget() const
+{
+    return ui->latencyTargetSpinBox->value();
+}
+
+int Settings::getFairQuantum() const
+{
+    return ui->fairQuantumSpinBox->value();
+}
+
+QHash<uint32_t, int> Settings::getModuleWeights() const
+{
+    QHash<uint32_t, int> weights;
+    const QStringList entries = ui->moduleWeightsLineEdit->text().split(',', Qt::SkipEmptyParts);
+    for (const QString &entry : entries)
+    {
+        const QStringList pair = entry.split(':');
+        bool idOk {false};
+        bool weightOk {false};
+        const uint moduleId = pair.value(0).trimmed().toUInt(&idOk);
+        const int weight = pair.value(1).trimmed().toInt(&weightOk);
+        if (pair.size() == 2 && idOk && weightOk && weight > 0)
+            weights.insert(moduleId, weight);
+    }
+    return weights;
+}
+
+bool Settings::isSpillEnabled() const
+{
+    return ui->spillCheckBox->isChecked();
+}
+
+int Settings::getSpillSize() const
+{
+    return ui->spillSizeSpinBox->value();
+}
+
+int Settings::getDisplayDecimation() const
+{
+    return ui->displayDecimationSpinBox->value();
+}
+
+bool Settings::isCoalescingEnabled() const
+{
+    return ui->coalesceCheckBox->isChecked();
+}
+
+int Settings::getCoalescingWindow() const
+{
+    return ui->coalesceWindowSpinBox->value();
+}
+
+bool Settings::isCoalescingByTemplate() const
+{
+    return ui->coalesceTemplatesCheckBox->isChecked();
+}
+
+int Settings::getShutdownDeadline() const
+{
+    return ui->shutdownDeadlineSpinBox->value();
+}
+
+int Settings::getFsyncInterval() const
+{
+    return ui->fsyncIntervalSpinBox->value();
+}
+
+int Settings::getWriterQueueSize() const
+{
+    return ui->writerQueueSizeSpinBox->value();
+}
+
+int Settings::getWriterQueuePolicy() const
+{
+    return ui->writerQueuePolicyComboBox->currentIndex();
+}
+
+int Settings::getRotationSize() const
+{
+    return ui->rotateSizeSpinBox->value();
+}
+
+int Settings::getRotationInterval() const
+{
+    return ui->rotateIntervalSpinBox->value();
+}
+
+bool Settings::isLogCompressionEnabled() const
+{
+    return ui->compressLogsCheckBox->isChecked();
+}
+
+int Settings::getRetainedFiles() const
+{
+    return ui->keepLogFilesSpinBox->value();
+}
+
+int Settings::getRetainedSize() const
+{
+    return ui->keepLogSizeSpinBox->value();
+}
+
+bool Settings::isBinaryLogFormat() const
+{
+    return ui->logFormatComboBox->currentIndex() == 1;
+}
+
+bool Settings::isPerModuleLogEnabled() const
+{
+    return ui->perModuleLogsCheckBox->isChecked();
+}
+
+QHash<uint32_t, QString> Settings::getLogGroups() const
+{
+    QHash<uint32_t, QString> groups;
+    const QStringList entries = ui->logGroupsLineEdit->text().split(',', Qt::SkipEmptyParts);
+    for (const QString &entry : entries)
+    {
+        const QStringList pair = entry.split(':');
+        bool idOk {false};
+        const uint moduleId = pair.value(0).trimmed().toUInt(&idOk);
+        const QString group = pair.value(1).trimmed();
+        if (pair.size() == 2 && idOk && !group.isEmpty())
+            groups.insert(moduleId, group);
+    }
+    return groups;
+}
+
+int Settings::getWriterThreadCount() const
+{
+    return ui->writerThreadsSpinBox->value();
+}
+
 
 void Settings::loadSettings(const QString & ipAddress, const int locaPort,
                             const double lowerThres, const double upperThress,
@@ -75,3 +239,121 @@ void Settings::loadSettings(const QString & ipAddress, const int locaPort,
     ui->plotTimeSpinBox->setValue(plotTime);
     ui->numSamplesAvgSpinBox->setValue(numSamplesAvg);
 }
+
+void Settings::setReceiverThreadCount(const int threadCount)
+{
+    ui->receiverThreadsSpinBox->setValue(threadCount);
+}
+
+void Settings::setSimulatedModuleCount(const int moduleCount)
+{
+    ui->simulatedModulesSpinBox->setValue(moduleCount);
+}
+
+void Settings::setFlowControlEnabled(const bool enabled)
+{
+    ui->flowControlCheckBox->setChecked(enabled);
+}
+
+void Settings::setFlushBatchSize(const int batchSize)
+{
+    ui->flushBatchSizeSpinBox->setValue(batchSize);
+}
+
+void Settings::setFlushTimeBudget(const int microseconds)
+{
+    ui->flushTimeBudgetSpinBox->setValue(microseconds);
+}
+
+void Settings::setAdaptiveFlushEnabled(const bool enabled)
+{
+    ui->adaptiveFlushCheckBox->setChecked(enabled);
+}
+
+void Settings::setLatencyTarget(const int milliseconds)
+{
+    ui->latencyTargetSpinBox->setValue(milliseconds);
+}
+
+void Settings::setFairQuantum(const int quantum)
+{
+    ui->fairQuantumSpinBox->setValue(quantum);
+}
+
+void Settings::setModuleWeights(const QHash<uint32_t, int> &weights)
+{
+    QList<uint32_t> moduleIds = weights.keys();
+    std::sort(moduleIds.begin(), moduleIds.end());
+    QStringList entries;
+    for (const uint32_t moduleId : moduleIds)
+        entries.append(QString("%1:%2").arg(moduleId).arg(weights.value(moduleId)));
+    ui->moduleWeightsLineEdit->setText(entries.join(", "));
+}
+
+void Settings::setSpillEnabled(const bool enabled)
+{
+    ui->spillCheckBox->setChecked(enabled);
+}
+
+void Settings::setSpillSize(const int mebibytes)
+{
+    ui->spillSizeSpinBox->setValue(mebibytes);
+}
+
+void Settings::setDisplayDecimation(const int decimation)
+{
+    ui->displayDecimationSpinBox->setValue(decimation);
+}
+
+void Settings::setCoalescing(const bool enabled, const int windowMs, const bool templates)
+{
+    ui->coalesceCheckBox->setChecked(enabled);
+    ui->coalesceWindowSpinBox->setValue(windowMs);
+    ui->coalesceTemplatesCheckBox->setChecked(templates);
+}
+
+void Settings::setShutdownDeadline(const int milliseconds)
+{
+    ui->shutdownDeadlineSpinBox->setValue(milliseconds);
+}
+
+void Settings::setFsyncInterval(const int milliseconds)
+{
+    ui->fsyncIntervalSpinBox->setValue(milliseconds);
+}
+
+void Settings::setWriterQueue(const int mebibytes, const int policy)
+{
+    ui->writerQueueSizeSpinBox->setValue(mebibytes);
+    ui->writerQueuePolicyComboBox->setCurrentIndex(policy);
+}
+
+void Settings::setRotation(const int mebibytes, const int minutes, const bool compress)
+{
+    ui->rotateSizeSpinBox->setValue(mebibytes);
+    ui->rotateIntervalSpinBox->setValue(minutes);
+    ui->compressLogsCheckBox->setChecked(compress);
+}
+
+void Settings::setRetention(const int files, const int mebibytes)
+{
+    ui->keepLogFilesSpinBox->setValue(files);
+    ui->keepLogSizeSpinBox->setValue(mebibytes);
+}
+
+void Settings::setBinaryLogFormat(const bool binary)
+{
+    ui->logFormatComboBox->setCurrentIndex(binary ? 1 : 0);
+}
+
+void Settings::setPerModuleLogs(const bool enabled, const QHash<uint32_t, QString> &groups, const int threads)
+{
+    ui->perModuleLogsCheckBox->setChecked(enabled);
+    QList<uint32_t> moduleIds = groups.keys();
+    std::sort(moduleIds.begin(), moduleIds.end());
+    QStringList entries;
+    for (const uint32_t moduleId : moduleIds)
+        entries.append(QString("%1:%2").arg(moduleId).arg(groups.value(moduleId)));
+    ui->logGroupsLineEdit->setText(entries.join(", "));
+    ui->writerThreadsSpinBox->setValue(threads);
+}
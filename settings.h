@@ -2,6 +2,7 @@
 #define SETTINGS_H
 
 #include <QDialog>
+#include <QHash>
 
 namespace Ui {
 class Settings;
@@ -21,6 +22,29 @@ public:
                     const int plotTime, const int numSamplesAvg,
                     const int flushInterval, const int ringBufferSize);
 
+    void setReceiverThreadCount(const int threadCount);
+    void setSimulatedModuleCount(const int moduleCount);
+    void setFlowControlEnabled(const bool enabled);
+    void setFlushBatchSize(const int batchSize);
+    void setFlushTimeBudget(const int microseconds);
+    void setAdaptiveFlushEnabled(const bool enabled);
+    void setLatencyTarget(const int milliseconds);
+    void setFairQuantum(const int quantum);
+    void setModuleWeights(const QHash<uint32_t, int> &weights);
+    void setSpillEnabled(const bool enabled);
+    void setSpillSize(const int mebibytes);
+    void setDisplayDecimation(const int decimation);
+    void setCoalescing(const bool enabled, const int windowMs, const bool templates);
+    void setShutdownDeadline(const int milliseconds);
+    // -1 = never, 0 = after every write
+    void setFsyncInterval(const int milliseconds);
+    // policy: 0 = block, 1 = drop by severity, 2 = spill
+    void setWriterQueue(const int mebibytes, const int policy);
+    void setRotation(const int mebibytes, const int minutes, const bool compress);
+    void setRetention(const int files, const int mebibytes);
+    void setBinaryLogFormat(const bool binary);
+    void setPerModuleLogs(const bool enabled, const QHash<uint32_t, QString> &groups, const int threads);
+
     // getter functions
     int getTcpPort() const;
     QString getIpAddress() const;
@@ -30,6 +54,36 @@ public:
     int getNumSamplesToAvg() const;
     int getFlushInterval() const;
     int getRingBufferSize() const;
+    int getReceiverThreadCount() const;
+    int getSimulatedModuleCount() const;
+    bool isFlowControlEnabled() const;
+    int getFlushBatchSize() const;
+    int getFlushTimeBudget() const;
+    bool isAdaptiveFlushEnabled() const;
+    int getLatencyTarget() const;
+    int getFairQuantum() const;
+    // module:weight pairs, malformed entries are skipped
+    QHash<uint32_t, int> getModuleWeights() const;
+    bool isSpillEnabled() const;
+    int getSpillSize() const;
+    int getDisplayDecimation() const;
+    bool isCoalescingEnabled() const;
+    int getCoalescingWindow() const;
+    bool isCoalescingByTemplate() const;
+    int getShutdownDeadline() const;
+    int getFsyncInterval() const;
+    int getWriterQueueSize() const;
+    int getWriterQueuePolicy() const;
+    int getRotationSize() const;
+    int getRotationInterval() const;
+    bool isLogCompressionEnabled() const;
+    int getRetainedFiles() const;
+    int getRetainedSize() const;
+    bool isBinaryLogFormat() const;
+    bool isPerModuleLogEnabled() const;
+    // module:group pairs, malformed entries are skipped
+    QHash<uint32_t, QString> getLogGroups() const;
+    int getWriterThreadCount() const;
 
 private:
     Ui::Settings *ui;
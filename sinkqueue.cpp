@@ -0,0 +1,313 @@
+#include "sinkqueue.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+// What a pending message costs: the message itself plus a text too long for its inline buffer
+inline qsizetype messageBytes(const EventMessage &msg)
+{
+    const qsizetype text = msg.text.size();
+    return qsizetype(sizeof(EventMessage)) + (text > MessageText::InlineCapacity ? text : 0);
+}
+
+inline qint64 steadyNs()
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+SinkQueue::SinkQueue(const SinkPolicy &policy)
+{
+    setPolicy(policy);
+}
+
+void SinkQueue::setPolicy(const SinkPolicy &policy)
+{
+    QMutexLocker locker(&m_mutex);
+    m_policy = policy;
+    m_policy.capacity = std::max<qsizetype>(policy.capacity, 0);
+    m_policy.capacityBytes = std::max<qsizetype>(policy.capacityBytes, 0);
+    m_policy.dataDecimation = std::max(policy.dataDecimation, 1);
+    trim();
+    m_room.wakeAll();
+}
+
+void SinkQueue::setNotifier(std::function<void()> notifier)
+{
+    QMutexLocker locker(&m_mutex);
+    m_notifier = std::move(notifier);
+}
+
+void SinkQueue::setRoomNotifier(std::function<void()> notifier)
+{
+    QMutexLocker locker(&m_mutex);
+    m_roomNotifier = std::move(notifier);
+}
+
+bool SinkQueue::openSpill(const QString &path, const qint64 capacity)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_spill.isOpen())
+        return true;
+    if (!m_spill.open(path, capacity))
+        return false;
+    // recovered messages are owed to the consumer like posted ones
+    m_posted += static_cast<quint64>(m_spill.size());
+    if (!m_spill.empty())
+        m_wait.wakeOne();
+    return true;
+}
+
+void SinkQueue::post(const EventMessageBatch &batch)
+{
+    if (batch.isEmpty())
+        return;
+
+    QMutexLocker locker(&m_mutex);
+    const EventMessageBatch accepted = m_policy.dataDecimation > 1 ? decimate(batch) : batch;
+    if (accepted.isEmpty())
+        return;
+
+    m_posted += static_cast<quint64>(accepted.size());
+    if (m_policy.dropPolicy == SinkDropPolicy::Spill && m_spill.isOpen())
+    {
+        // Once anything is on disk, newer messages queue up behind it. Only what
+        // a full spill file turns away is dropped, a refill may overshoot a little.
+        bool spillFull {false};
+        for (const EventMessage &msg : accepted)
+        {
+            const bool inMemory = m_spill.empty() && fits(msg);
+            if (inMemory || !m_spill.push(msg))
+            {
+                spillFull = spillFull || !inMemory;
+                m_pending.append(msg);
+                m_pendingBytes += messageBytes(msg);
+            }
+        }
+        if (spillFull)
+            trim();
+    }
+    else
+    {
+        append(accepted);
+        trim();
+    }
+    m_highWaterBytes = std::max(m_highWaterBytes, m_pendingBytes);
+    m_wait.wakeOne();
+
+    if (m_notified || !m_notifier)
+        return;
+    m_notified = true;
+    const std::function<void()> notifier = m_notifier;
+    locker.unlock();
+    notifier();
+}
+
+quint64 SinkQueue::postedCount()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_posted;
+}
+
+bool SinkQueue::acceptsMore()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_policy.dropPolicy != SinkDropPolicy::Block || !isFull())
+        return true;
+    if (m_blockedSinceNs == 0)
+        m_blockedSinceNs = steadyNs();
+    return false;
+}
+
+bool SinkQueue::waitForRoom(QDeadlineTimer deadline)
+{
+    QMutexLocker locker(&m_mutex);
+    while (m_policy.dropPolicy == SinkDropPolicy::Block && isFull() && !m_closed)
+    {
+        if (m_blockedSinceNs == 0)
+            m_blockedSinceNs = steadyNs();
+        if (!m_room.wait(&m_mutex, deadline))
+            return false;
+    }
+    return true;
+}
+
+EventMessageBatch SinkQueue::take(quint64 &dropped)
+{
+    QMutexLocker locker(&m_mutex);
+    return takePending(dropped, locker);
+}
+
+EventMessageBatch SinkQueue::waitAndTake(quint64 &dropped, QDeadlineTimer deadline)
+{
+    QMutexLocker locker(&m_mutex);
+    while (m_pending.isEmpty() && m_spill.empty() && !m_closed && !m_consumerWoken)
+    {
+        if (!m_wait.wait(&m_mutex, deadline))
+            break;
+    }
+    m_consumerWoken = false;
+    return takePending(dropped, locker);
+}
+
+void SinkQueue::wakeConsumer()
+{
+    QMutexLocker locker(&m_mutex);
+    m_consumerWoken = true;
+    m_wait.wakeAll();
+}
+
+void SinkQueue::close()
+{
+    QMutexLocker locker(&m_mutex);
+    m_closed = true;
+    m_wait.wakeAll();
+    m_room.wakeAll();
+}
+
+bool SinkQueue::isClosed()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_closed;
+}
+
+SinkQueue::Stats SinkQueue::stats()
+{
+    QMutexLocker locker(&m_mutex);
+    Stats stats;
+    stats.queued = m_pending.size();
+    stats.queuedBytes = m_pendingBytes;
+    stats.capacityBytes = m_policy.capacityBytes;
+    stats.highWaterBytes = m_highWaterBytes;
+    stats.spilled = static_cast<quint64>(m_spill.size());
+    stats.dropped = m_droppedTotal;
+    stats.blockedNs = m_blockedNs;
+    stats.blockedSinceNs = m_blockedSinceNs;
+    return stats;
+}
+
+// Keeps every non-DATA message and every n-th DATA message per module
+EventMessageBatch SinkQueue::decimate(const EventMessageBatch &batch)
+{
+    EventMessageBatch kept;
+    kept.reserve(batch.size());
+    for (const EventMessage &msg : batch)
+    {
+        if (msg.severity == Severity::Data && m_dataCount[msg.clientId]++ % static_cast<quint32>(m_policy.dataDecimation) != 0)
+            continue;
+        kept.append(msg);
+    }
+    return kept;
+}
+
+bool SinkQueue::isFull() const
+{
+    return (m_policy.capacity > 0 && m_pending.size() >= m_policy.capacity)
+           || (m_policy.capacityBytes > 0 && m_pendingBytes >= m_policy.capacityBytes);
+}
+
+bool SinkQueue::fits(const EventMessage &msg) const
+{
+    return (m_policy.capacity == 0 || m_pending.size() < m_policy.capacity)
+           && (m_policy.capacityBytes == 0 || m_pendingBytes + messageBytes(msg) <= m_policy.capacityBytes);
+}
+
+void SinkQueue::append(const EventMessageBatch &batch)
+{
+    if (m_pending.isEmpty())
+        m_pending = batch;  // shares the batch, no copy
+    else
+        m_pending.append(batch);
+    for (const EventMessage &msg : batch)
+        m_pendingBytes += messageBytes(msg);
+}
+
+// Brings the queue back within its capacity according to the drop policy
+void SinkQueue::trim()
+{
+    const auto over = [this](const qsizetype count, const qsizetype bytes) {
+        return (m_policy.capacity > 0 && count > m_policy.capacity)
+               || (m_policy.capacityBytes > 0 && bytes > m_policy.capacityBytes);
+    };
+    if (!over(m_pending.size(), m_pendingBytes))
+        return;
+
+    qsizetype count = m_pending.size();
+    qsizetype removed {0};
+    switch (m_policy.dropPolicy)
+    {
+    case SinkDropPolicy::Block:
+        return;
+    case SinkDropPolicy::DropOldest:
+        while (over(count, m_pendingBytes))
+        {
+            m_pendingBytes -= messageBytes(m_pending.at(removed++));
+            --count;
+        }
+        m_pending.remove(0, removed);
+        break;
+    case SinkDropPolicy::DropNewest:
+        while (over(count, m_pendingBytes))
+        {
+            m_pendingBytes -= messageBytes(m_pending.at(--count));
+            ++removed;
+        }
+        m_pending.resize(count);
+        break;
+    case SinkDropPolicy::DropBySeverity:
+    case SinkDropPolicy::Spill:
+        for (int severity = 0; severity < SeverityCount && over(count, m_pendingBytes); ++severity)
+        {
+            m_pending.removeIf([&](const EventMessage &msg) {
+                if (msg.severity != static_cast<Severity>(severity) || !over(count, m_pendingBytes))
+                    return false;
+                m_pendingBytes -= messageBytes(msg);
+                --count;
+                ++removed;
+                return true;
+            });
+        }
+        break;
+    }
+    m_dropped += static_cast<quint64>(removed);
+    m_droppedTotal += static_cast<quint64>(removed);
+}
+
+void SinkQueue::refillFromSpill()
+{
+    EventMessage msg;
+    while (!isFull() && m_spill.pop(msg))
+    {
+        m_pendingBytes += messageBytes(msg);
+        m_pending.append(std::move(msg));
+    }
+}
+
+EventMessageBatch SinkQueue::takePending(quint64 &dropped, QMutexLocker<QMutex> &locker)
+{
+    if (m_pending.isEmpty())
+        refillFromSpill();
+    EventMessageBatch batch;
+    batch.swap(m_pending);
+    m_pendingBytes = 0;
+    // the next batch is ready in memory while this one is consumed
+    refillFromSpill();
+
+    dropped = m_dropped;
+    m_dropped = 0;
+    m_notified = false;
+    m_room.wakeAll();
+
+    if (m_blockedSinceNs == 0 || isFull())
+        return batch;
+    m_blockedNs += steadyNs() - m_blockedSinceNs;
+    m_blockedSinceNs = 0;
+    const std::function<void()> roomNotifier = m_roomNotifier;
+    locker.unlock();
+    if (roomNotifier)
+        roomNotifier();
+    return batch;
+}
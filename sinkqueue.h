@@ -0,0 +1,107 @@
+#ifndef SINKQUEUE_H
+#define SINKQUEUE_H
+
+#include <QDeadlineTimer>
+#include <QHash>
+#include <QMutex>
+#include <QWaitCondition>
+#include <functional>
+#include "logsink.h"
+#include "spillqueue.h"
+
+// The pending messages of one sink, between the Logger and the sink's consumer.
+// post() applies the sink's policy: DATA decimation first, then the capacity in
+// messages and/or bytes, dropping the oldest, the newest or the least severe
+// messages and counting them. The consumer takes everything pending in one go,
+// either polling with take() (the display, which is woken by the notifier on
+// the first post after a take) or blocking in waitAndTake() on its own thread
+// (the Writer).
+// With SinkDropPolicy::Block post() still accepts everything; the producer is
+// expected to ask acceptsMore() first and hold its messages back while the
+// queue is full. The time from the first refusal until a take makes room again
+// counts as blocked, and the room notifier reports the end of it.
+// With SinkDropPolicy::Spill and a spill file opened, messages past the
+// capacity (and all later ones while the file is not empty) go to disk and are
+// moved back in order as the consumer takes; without a file, or with a full
+// one, the queue drops by severity.
+class SinkQueue : public LogSink
+{
+public:
+    struct Stats {
+        qsizetype queued {0};
+        qsizetype queuedBytes {0};
+        qsizetype capacityBytes {0};
+        qsizetype highWaterBytes {0};
+        quint64 spilled {0};        // in the spill file
+        quint64 dropped {0};        // since the queue was created
+        qint64 blockedNs {0};       // completed blocked periods
+        qint64 blockedSinceNs {0};  // steady clock, 0 = not blocked
+    };
+
+    explicit SinkQueue(const SinkPolicy &policy = {});
+
+    SinkQueue(const SinkQueue&) = delete;
+    SinkQueue& operator=(const SinkQueue&) = delete;
+
+    void setPolicy(const SinkPolicy &policy);
+    // Runs on the posting thread, outside the lock
+    void setNotifier(std::function<void()> notifier);
+    // Runs on the consuming thread, outside the lock, when a take ends a blocked period
+    void setRoomNotifier(std::function<void()> notifier);
+    // Recovers the messages a previous run left in the file, see SpillQueue
+    bool openSpill(const QString &path, const qint64 capacity);
+
+    void post(const EventMessageBatch &batch) override;
+    // Messages accepted by post() so far, including those dropped later for the capacity
+    quint64 postedCount();
+
+    // Block policy: false while the queue is full, which starts a blocked period
+    bool acceptsMore();
+    // Block policy: waits for room, false if the deadline expired first
+    bool waitForRoom(QDeadlineTimer deadline);
+
+    // dropped receives the number of messages dropped since the last take
+    EventMessageBatch take(quint64 &dropped);
+    // Waits for messages. An empty batch means the queue was closed and is drained,
+    // the deadline expired or wakeConsumer() was called.
+    EventMessageBatch waitAndTake(quint64 &dropped, QDeadlineTimer deadline = QDeadlineTimer::Forever);
+    // Makes the current or next waitAndTake() return even without messages
+    void wakeConsumer();
+    void close();
+    bool isClosed();
+
+    Stats stats();
+
+private:
+    EventMessageBatch decimate(const EventMessageBatch &batch);
+    bool isFull() const;
+    bool fits(const EventMessage &msg) const;
+    void append(const EventMessageBatch &batch);
+    void trim();
+    void dropBySeverity();
+    void refillFromSpill();
+    EventMessageBatch takePending(quint64 &dropped, QMutexLocker<QMutex> &locker);
+
+private:
+    QMutex m_mutex;
+    QWaitCondition m_wait;
+    QWaitCondition m_room;
+    EventMessageBatch m_pending;
+    qsizetype m_pendingBytes {0};
+    SinkPolicy m_policy;
+    SpillQueue m_spill;
+    QHash<uint32_t, quint32> m_dataCount;
+    std::function<void()> m_notifier;
+    std::function<void()> m_roomNotifier;
+    quint64 m_posted {0};
+    quint64 m_dropped {0};
+    quint64 m_droppedTotal {0};
+    qsizetype m_highWaterBytes {0};
+    qint64 m_blockedNs {0};
+    qint64 m_blockedSinceNs {0};
+    bool m_notified {false};
+    bool m_consumerWoken {false};
+    bool m_closed {false};
+};
+
+#endif // SINKQUEUE_H
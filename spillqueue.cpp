@@ -0,0 +1,243 @@
+#include "spillqueue.h"
+#include <QDebug>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+
+namespace {
+constexpr char s_magic[8] {'E', 'M', 'S', 'P', 'I', 'L', 'L', '1'};
+constexpr uint32_t s_version {1};
+constexpr uint32_t s_wrapFlag {0x80000000u};
+constexpr qint64 s_minCapacity {64 * 1024};
+constexpr size_t s_maxTextLength {0xFFFF};
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    quint64 dataSize;
+    quint64 head;       // byte counters, the position in the ring is modulo dataSize
+    quint64 tail;
+    char padding[24];
+};
+static_assert(sizeof(FileHeader) == 64);
+
+struct RecordHeader {
+    uint32_t size;      // whole record padded to 8 bytes, with s_wrapFlag: bytes skipped to the ring start
+    uint32_t checksum;  // CRC-16 of everything after this field
+    qint64 timestamp;
+    uint32_t clientId;
+    uint8_t severity;
+    uint8_t reserved;
+    uint16_t textLength;
+};
+static_assert(sizeof(RecordHeader) == 24);
+
+constexpr quint64 s_headOffset {offsetof(FileHeader, head)};
+constexpr quint64 s_tailOffset {offsetof(FileHeader, tail)};
+constexpr size_t s_checksumOffset {offsetof(RecordHeader, timestamp)};
+
+quint64 alignedSize(const size_t textLength)
+{
+    return (sizeof(RecordHeader) + textLength + 7) & ~quint64(7);
+}
+}
+
+SpillQueue::~SpillQueue()
+{
+    close();
+}
+
+bool SpillQueue::open(const QString &path, const qint64 capacity)
+{
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        qWarning() << "Cannot open spill file" << path << m_file.errorString();
+        return false;
+    }
+
+    FileHeader header {};
+    const bool existing = m_file.size() >= qint64(sizeof(FileHeader))
+                          && m_file.read(reinterpret_cast<char *>(&header), sizeof(header)) == qint64(sizeof(header))
+                          && std::memcmp(header.magic, s_magic, sizeof(s_magic)) == 0
+                          && header.version == s_version
+                          && header.dataSize > 0 && header.dataSize % 8 == 0
+                          && m_file.size() == qint64(sizeof(FileHeader) + header.dataSize)
+                          && header.head <= header.tail && header.tail - header.head <= header.dataSize
+                          && header.head != header.tail;
+
+    if (!existing) {
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, s_magic, sizeof(s_magic));
+        header.version = s_version;
+        header.dataSize = quint64(std::max(capacity, s_minCapacity)) & ~quint64(7);
+        if (!m_file.resize(0) || !m_file.resize(qint64(sizeof(FileHeader) + header.dataSize))
+            || !m_file.seek(0) || m_file.write(reinterpret_cast<const char *>(&header), sizeof(header)) != qint64(sizeof(header))
+            || !m_file.flush()) {
+            qWarning() << "Cannot create spill file" << path << m_file.errorString();
+            m_file.close();
+            return false;
+        }
+    }
+
+    m_map = m_file.map(0, m_file.size());
+    if (!m_map) {
+        qWarning() << "Cannot map spill file" << path << m_file.errorString();
+        m_file.close();
+        return false;
+    }
+    m_data = m_map + sizeof(FileHeader);
+    m_dataSize = header.dataSize;
+    m_head = header.head;
+    m_tail = header.tail;
+    m_count = 0;
+    if (existing)
+        recover();
+    return true;
+}
+
+void SpillQueue::close()
+{
+    if (m_map) {
+        m_file.unmap(m_map);
+        m_map = nullptr;
+        m_data = nullptr;
+    }
+    if (m_file.isOpen())
+        m_file.close();
+    m_dataSize = 0;
+    m_head = 0;
+    m_tail = 0;
+    m_count = 0;
+}
+
+bool SpillQueue::isOpen() const
+{
+    return m_map != nullptr;
+}
+
+bool SpillQueue::empty() const
+{
+    return m_head == m_tail;
+}
+
+size_t SpillQueue::size() const
+{
+    return m_count;
+}
+
+qint64 SpillQueue::usedBytes() const
+{
+    return qint64(m_tail - m_head);
+}
+
+bool SpillQueue::push(const EventMessage &msg)
+{
+    if (!m_map)
+        return false;
+
+    const QByteArrayView text = msg.text.utf8().first(std::min<qsizetype>(msg.text.size(), s_maxTextLength));
+    const quint64 size = alignedSize(size_t(text.size()));
+    const quint64 offset = m_tail % m_dataSize;
+    const quint64 skip = m_dataSize - offset < size ? m_dataSize - offset : 0;
+    if (m_tail - m_head + skip + size > m_dataSize)
+        return false;
+
+    quint64 tail = m_tail;
+    if (skip > 0) {
+        const uint32_t marker = uint32_t(skip) | s_wrapFlag;
+        std::memcpy(m_data + offset, &marker, sizeof(marker));
+        tail += skip;
+    }
+
+    uchar *record = m_data + tail % m_dataSize;
+    RecordHeader header {};
+    header.size = uint32_t(size);
+    header.timestamp = msg.timestamp;
+    header.clientId = msg.clientId;
+    header.severity = static_cast<uint8_t>(msg.severity);
+    header.textLength = uint16_t(text.size());
+    std::memcpy(record, &header, sizeof(header));
+    std::memcpy(record + sizeof(header), text.data(), size_t(text.size()));
+    header.checksum = qChecksum(QByteArrayView(record + s_checksumOffset, qsizetype(sizeof(header) - s_checksumOffset) + text.size()));
+    std::memcpy(record + offsetof(RecordHeader, checksum), &header.checksum, sizeof(header.checksum));
+
+    // publish only complete records
+    storeTail(tail + size);
+    ++m_count;
+    return true;
+}
+
+bool SpillQueue::pop(EventMessage &msg)
+{
+    if (empty())
+        return false;
+
+    quint64 head = m_head;
+    uint32_t size {0};
+    std::memcpy(&size, m_data + head % m_dataSize, sizeof(size));
+    if (size & s_wrapFlag)
+        head += size & ~s_wrapFlag;
+
+    const uchar *record = m_data + head % m_dataSize;
+    RecordHeader header;
+    std::memcpy(&header, record, sizeof(header));
+    msg.timestamp = header.timestamp;
+    msg.clientId = header.clientId;
+    msg.severity = static_cast<Severity>(header.severity);
+    msg.text = MessageText::fromUtf8(QByteArrayView(record + sizeof(header), header.textLength));
+
+    storeHead(head + header.size);
+    --m_count;
+    return true;
+}
+
+// Walks the records between head and tail and moves the tail back to the end of the last intact one
+void SpillQueue::recover()
+{
+    quint64 pos = m_head;
+    m_count = 0;
+    while (pos < m_tail) {
+        const quint64 offset = pos % m_dataSize;
+        uint32_t size {0};
+        std::memcpy(&size, m_data + offset, sizeof(size));
+        if (size & s_wrapFlag) {
+            if ((size & ~s_wrapFlag) != m_dataSize - offset)
+                break;
+            pos += size & ~s_wrapFlag;
+            continue;
+        }
+
+        RecordHeader header;
+        if (m_dataSize - offset < sizeof(header))
+            break;
+        std::memcpy(&header, m_data + offset, sizeof(header));
+        if (header.size != alignedSize(header.textLength) || header.size > m_dataSize - offset
+            || header.size > m_tail - pos || header.severity >= SeverityCount
+            || header.checksum != qChecksum(QByteArrayView(m_data + offset + s_checksumOffset,
+                                                            qsizetype(sizeof(header) - s_checksumOffset) + header.textLength)))
+            break;
+        pos += header.size;
+        ++m_count;
+    }
+
+    if (pos != m_tail) {
+        qWarning() << "Spill file" << m_file.fileName() << "is damaged, dropping"
+                   << (m_tail - pos) << "bytes after" << m_count << "intact messages";
+        storeTail(pos);
+    }
+}
+
+void SpillQueue::storeHead(const quint64 head)
+{
+    m_head = head;
+    std::atomic_ref<quint64>(*reinterpret_cast<quint64 *>(m_map + s_headOffset)).store(head, std::memory_order_release);
+}
+
+void SpillQueue::storeTail(const quint64 tail)
+{
+    m_tail = tail;
+    std::atomic_ref<quint64>(*reinterpret_cast<quint64 *>(m_map + s_tailOffset)).store(tail, std::memory_order_release);
+}
@@ -0,0 +1,57 @@
+#ifndef SPILLQUEUE_H
+#define SPILLQUEUE_H
+
+#include <QFile>
+#include <QString>
+#include "eventmessage.h"
+
+// Overflow tier of the Logger buffer and of the Writer's queue: a FIFO of
+// messages in a memory-mapped file of fixed size, used as a ring.
+//
+// A record is a 24 byte header (size, CRC-16, timestamp, client, severity,
+// text length) followed by the UTF-8 text, padded to 8 bytes. Records never
+// wrap; a marker skips the unused end of the ring. The file header keeps the
+// read and write positions. A record is written completely before the write
+// position is advanced over it, so the mapping always describes a consistent
+// queue, and since it is a shared file mapping it outlives a crash of the
+// process. open() walks a file left behind, checking every record, and cuts
+// the queue at the first damaged one.
+class SpillQueue
+{
+public:
+    SpillQueue() = default;
+    ~SpillQueue();
+
+    SpillQueue(const SpillQueue&) = delete;
+    SpillQueue& operator=(const SpillQueue&) = delete;
+
+    // Maps path, recovering the messages a previous run left in it. An empty or
+    // unusable file is recreated with capacity bytes, a recovered one keeps its size.
+    bool open(const QString &path, const qint64 capacity);
+    void close();
+    bool isOpen() const;
+
+    bool empty() const;
+    size_t size() const;
+    qint64 usedBytes() const;
+
+    // False if the message does not fit, texts are cut at 65535 bytes
+    bool push(const EventMessage &msg);
+    bool pop(EventMessage &msg);
+
+private:
+    void recover();
+    void storeHead(const quint64 head);
+    void storeTail(const quint64 tail);
+
+private:
+    QFile m_file;
+    uchar *m_map {nullptr};
+    uchar *m_data {nullptr};
+    quint64 m_dataSize {0};
+    quint64 m_head {0};
+    quint64 m_tail {0};
+    size_t m_count {0};
+};
+
+#endif // SPILLQUEUE_H
@@ -0,0 +1,28 @@
+#ifndef THREADUTILS_H
+#define THREADUTILS_H
+
+#include <QObject>
+#include <QThread>
+#include <concepts>
+
+template<class F>
+concept QtZeroArgInvocable =
+    std::invocable<F&> &&
+    std::same_as<void, std::invoke_result_t<F&>> &&
+    std::is_move_constructible_v<std::decay_t<F>>;
+
+// Runs func right away when called on obj's thread, otherwise queues it there
+template<class Obj, class F>
+    requires std::derived_from<Obj, QObject> && QtZeroArgInvocable<F>
+void invokeOnObjectThread(Obj * obj, F&& func)
+{
+    if (QThread::currentThread() == obj->thread()) {
+        func();
+    } else {
+        QMetaObject::invokeMethod(obj,[fn = std::forward<F>(func)]() mutable {
+            fn();
+        }, Qt::QueuedConnection);
+    }
+}
+
+#endif // THREADUTILS_H
@@ -0,0 +1,136 @@
+#include "timestampparser.h"
+#include <QDate>
+#include <QDateTime>
+#include <QTime>
+#include <cstring>
+
+namespace {
+
+constexpr qsizetype s_secondLength {19};    // yyyy-MM-dd HH:mm:ss
+constexpr qsizetype s_minuteLength {16};    // yyyy-MM-dd HH:mm
+constexpr qsizetype s_maxFractionDigits {9};
+constexpr qsizetype s_maxEpochDigits {18};
+constexpr qint64 s_epochMicrosFrom {100000000000000LL};  // 10^14, as ms that is the year 5138
+constexpr qint64 s_microsPerSecond {1000000};
+
+inline bool isDigit(const char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+inline bool parseDigits(const char *p, const int count, int &value)
+{
+    value = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        if (!isDigit(p[i]))
+            return false;
+        value = value * 10 + (p[i] - '0');
+    }
+    return true;
+}
+
+// ".f" with one to nine digits, truncated to microseconds. Empty means no fraction.
+bool parseFraction(const QByteArrayView text, qint64 &micros)
+{
+    micros = 0;
+    if (text.isEmpty())
+        return true;
+
+    const qsizetype digits = text.size() - 1;
+    if (text[0] != '.' || digits < 1 || digits > s_maxFractionDigits)
+        return false;
+
+    qint64 scale = 100000;
+    for (qsizetype i = 1; i <= digits; ++i)
+    {
+        if (!isDigit(text[i]))
+            return false;
+        micros += (text[i] - '0') * scale;
+        scale /= 10;
+    }
+    return true;
+}
+
+bool parseEpoch(const QByteArrayView text, qint64 &epochMicros)
+{
+    if (text.isEmpty() || text.size() > s_maxEpochDigits)
+        return false;
+
+    qint64 value {0};
+    for (const char c : text)
+    {
+        if (!isDigit(c))
+            return false;
+        value = value * 10 + (c - '0');
+    }
+    epochMicros = value < s_epochMicrosFrom ? value * 1000 : value;
+    return true;
+}
+
+} // namespace
+
+bool TimestampParser::parse(const QByteArrayView text, qint64 &epochMicros)
+{
+    if (text.size() >= s_secondLength && text[4] == '-')
+        return parseDateTime(text, epochMicros);
+
+    return parseEpoch(text, epochMicros);
+}
+
+bool TimestampParser::parseDateTime(const QByteArrayView text, qint64 &epochMicros)
+{
+    qint64 fraction {0};
+    if (!parseFraction(text.sliced(s_secondLength), fraction))
+        return false;
+
+    const char *p = text.data();
+    if (m_secondValid && std::memcmp(p, m_second, s_secondLength) == 0)
+    {
+        epochMicros = m_secondMicros + fraction;
+        return true;
+    }
+
+    int second {0};
+    if (p[16] != ':' || !parseDigits(p + 17, 2, second) || second > 59)
+        return false;
+
+    if (!m_minuteValid || std::memcmp(p, m_minute, s_minuteLength) != 0)
+    {
+        if (!resolveMinute(p))
+            return false;
+    }
+
+    m_secondMicros = m_minuteMicros + second * s_microsPerSecond;
+    std::memcpy(m_second, p, s_secondLength);
+    m_secondValid = true;
+
+    epochMicros = m_secondMicros + fraction;
+    return true;
+}
+
+bool TimestampParser::resolveMinute(const char *text)
+{
+    if (text[4] != '-' || text[7] != '-' || (text[10] != ' ' && text[10] != 'T') || text[13] != ':')
+        return false;
+
+    int year {0}, month {0}, day {0}, hour {0}, minute {0};
+    if (!parseDigits(text, 4, year) || !parseDigits(text + 5, 2, month) || !parseDigits(text + 8, 2, day)
+        || !parseDigits(text + 11, 2, hour) || !parseDigits(text + 14, 2, minute))
+        return false;
+    if (hour > 23 || minute > 59)
+        return false;
+
+    const QDate date(year, month, day);
+    if (!date.isValid())
+        return false;
+
+    const QDateTime dateTime(date, QTime(hour, minute));
+    if (!dateTime.isValid())
+        return false;
+
+    m_minuteMicros = dateTime.toMSecsSinceEpoch() * 1000;
+    std::memcpy(m_minute, text, s_minuteLength);
+    m_minuteValid = true;
+    return true;
+}
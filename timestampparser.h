@@ -0,0 +1,35 @@
+#ifndef TIMESTAMPPARSER_H
+#define TIMESTAMPPARSER_H
+
+#include <QByteArrayView>
+
+// Parser for the timestamp field of an event line. Accepted are
+//   "yyyy-MM-dd HH:mm:ss" (or 'T' as separator), local time, optionally followed
+//   by a fraction of up to nine digits ("...:51.250"), resolved to microseconds
+//   plain integers: Unix epoch milliseconds, or microseconds from 10^14 on
+// The result is microseconds since the Unix epoch.
+// Consecutive messages nearly always share their second, so the epoch value of
+// the last second and of the last minute are cached: the common case is a single
+// memcmp, a new second within the same minute is plain arithmetic, and only a new
+// minute goes through QDateTime for the calendar and timezone resolution.
+class TimestampParser
+{
+public:
+    TimestampParser() = default;
+
+    bool parse(QByteArrayView text, qint64 &epochMicros);
+
+private:
+    bool parseDateTime(QByteArrayView text, qint64 &epochMicros);
+    bool resolveMinute(const char *text);
+
+private:
+    char m_second[19] {};
+    char m_minute[16] {};
+    qint64 m_secondMicros {0};
+    qint64 m_minuteMicros {0};
+    bool m_secondValid {false};
+    bool m_minuteValid {false};
+};
+
+#endif // TIMESTAMPPARSER_H
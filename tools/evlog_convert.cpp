@@ -0,0 +1,163 @@
+// Converts binary log segments (.evlog) to the text layout of the log file,
+// line for line what the Writer would have written in the text format.
+// With --from / --to only the blocks whose time span overlaps the range are
+// read, so extracting a few minutes of a large segment is a few seeks.
+// Text segments the LogCompressor compressed (.txt.qz) are restored whole, so
+// a mix of both reads back as one text log, e.g. `evlog_convert logs/*.qz | less`.
+//
+//   evlog_convert [--from <time>] [--to <time>] [--output <file>] [--info] <segment.evlog|segment.txt.qz>...
+//
+// Times are given like the timestamp field of an event line: "yyyy-MM-dd HH:mm:ss[.fff]"
+// in local time or Unix epoch milliseconds. Without --output the text goes to stdout.
+// Exit code 0 on success, 1 for bad arguments or unreadable files, 2 if damaged
+// blocks were skipped.
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QTextStream>
+#include <limits>
+
+#include "binarylog.h"
+#include "logcompressor.h"
+#include "logformatter.h"
+#include "timestampparser.h"
+
+namespace {
+
+constexpr qsizetype s_writeChunk {1024 * 1024};
+constexpr auto s_compressedSuffix {".qz"};
+
+bool parseTime(const QString &text, qint64 &timestamp)
+{
+    TimestampParser parser;
+    const QByteArray utf8 = text.trimmed().toUtf8();
+    return parser.parse(QByteArrayView(utf8), timestamp);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("evlog_convert");
+    QTextStream err(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Converts binary log segments (.evlog) to the text log layout and restores compressed text segments (.txt.qz)");
+    parser.addHelpOption();
+    const QCommandLineOption fromOption("from", "First timestamp to convert.", "time");
+    const QCommandLineOption toOption("to", "Last timestamp to convert.", "time");
+    const QCommandLineOption outputOption({"o", "output"}, "Write to file instead of stdout.", "file");
+    const QCommandLineOption infoOption("info", "Print the block index instead of converting.");
+    parser.addOptions({fromOption, toOption, outputOption, infoOption});
+    parser.addPositionalArgument("segments", "Binary or compressed text segments, converted in the given order.", "<segment.evlog|segment.txt.qz>...");
+    parser.process(app);
+
+    const QStringList segments = parser.positionalArguments();
+    if (segments.isEmpty())
+        parser.showHelp(1);
+
+    qint64 from = std::numeric_limits<qint64>::min();
+    qint64 to = std::numeric_limits<qint64>::max();
+    if (parser.isSet(fromOption) && !parseTime(parser.value(fromOption), from))
+    {
+        err << "Invalid --from time: " << parser.value(fromOption) << "\n";
+        return 1;
+    }
+    if (parser.isSet(toOption) && !parseTime(parser.value(toOption), to))
+    {
+        err << "Invalid --to time: " << parser.value(toOption) << "\n";
+        return 1;
+    }
+
+    QFile output;
+    const bool opened = parser.isSet(outputOption)
+        ? (output.setFileName(parser.value(outputOption)), output.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        : output.open(stdout, QIODevice::WriteOnly);
+    if (!opened)
+    {
+        err << "Cannot open output: " << output.errorString() << "\n";
+        return 1;
+    }
+    QTextStream info(&output);
+
+    bool damaged {false};
+    LogFormatter formatter;
+    QByteArray text;
+    text.reserve(s_writeChunk + 4096);
+    for (const QString &path : segments)
+    {
+        if (path.endsWith(s_compressedSuffix))
+        {
+            // time ranges apply to binary segments only, a text segment is restored whole
+            if (parser.isSet(infoOption))
+            {
+                info << path << ": compressed text segment\n";
+                continue;
+            }
+            if (!QFile(path).open(QIODevice::ReadOnly))
+            {
+                err << "Cannot read " << path << "\n";
+                return 1;
+            }
+            info.flush();
+            if (!LogCompressor::decompress(path, output))
+            {
+                if (output.error() != QFileDevice::NoError)
+                {
+                    err << "Cannot write output: " << output.errorString() << "\n";
+                    return 1;
+                }
+                err << path << ": damaged, restored up to the first damaged chunk\n";
+                damaged = true;
+            }
+            continue;
+        }
+
+        BinaryLogReader reader;
+        if (!reader.open(path))
+        {
+            err << "Cannot read " << path << ": " << reader.errorString() << "\n";
+            return 1;
+        }
+        if (!reader.hasFooter())
+            err << path << ": no index, the segment was not closed; recovered " << reader.messageCount() << " messages\n";
+
+        if (parser.isSet(infoOption))
+        {
+            info << path << ": " << reader.messageCount() << " messages in " << reader.blocks().size() << " blocks\n";
+            for (const BinaryLogReader::Block &block : reader.blocks())
+            {
+                info << "  offset " << block.offset << "  messages " << block.count
+                     << "  " << timestampToDateTime(block.minTimestamp).toString("yyyy-MM-dd HH:mm:ss.zzz")
+                     << " .. " << timestampToDateTime(block.maxTimestamp).toString("yyyy-MM-dd HH:mm:ss.zzz") << "\n";
+            }
+            continue;
+        }
+
+        bool writeFailed {false};
+        const bool ok = reader.read(from, to, [&](const EventMessage &msg) {
+            formatter.append(text, msg);
+            if (text.size() >= s_writeChunk)
+            {
+                writeFailed = output.write(text) != text.size() || writeFailed;
+                text.resize(0);
+            }
+        });
+        writeFailed = output.write(text) != text.size() || writeFailed;
+        text.resize(0);
+        if (writeFailed)
+        {
+            err << "Cannot write output: " << output.errorString() << "\n";
+            return 1;
+        }
+        if (!ok)
+        {
+            err << path << ": skipped damaged blocks\n";
+            damaged = true;
+        }
+    }
+    info.flush();
+    return damaged ? 2 : 0;
+}
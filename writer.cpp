@@ -1,62 +1,247 @@
 #include "writer.h"
-#include <QDateTime>
+#include <QDebug>
+#include <QFileInfo>
+#include <algorithm>
 
 Writer::Writer(QObject *parent)
-    : QThread(parent) {}
+    : QThread(parent),
+    m_queue{std::make_shared<SinkQueue>()}
+{
+    // the pool threads live as long as the Writer instead of being restarted per batch
+    m_pool.setExpiryTimeout(-1);
+    m_pool.setMaxThreadCount(0);
+}
 
 Writer::~Writer()
 {
-    QMutexLocker locker(&m_mutex);
-    m_running = false;
-    m_wait.wakeAll();
-    locker.unlock();
+    m_queue->close();
     wait();
 }
 
 void Writer::setLogFilePath(const QString &path)
 {
-    QMutexLocker locker(&m_mutex);
     m_logFilePath = path;
+    m_activePaths = QStringList{path};
+}
+
+void Writer::setBinaryFormat(const bool binary)
+{
+    m_binaryFormat = binary;
+}
+
+void Writer::setCompressor(std::shared_ptr<LogCompressor> compressor)
+{
+    m_compressor = std::move(compressor);
+}
+
+void Writer::setRouting(const bool perModule, const QHash<uint32_t, QString> &groups)
+{
+    m_perModule = perModule;
+    m_groups.clear();
+    // group names end up in file names
+    for (auto it = groups.cbegin(); it != groups.cend(); ++it) {
+        QString name;
+        for (const QChar c : it.value().trimmed())
+            name += (c.isLetterOrNumber() || c == u'-') ? c : QChar(u'_');
+        if (!name.isEmpty())
+            m_groups.insert(it.key(), name);
+    }
+    m_activePaths = perModule ? QStringList() : QStringList{m_logFilePath};
+}
+
+void Writer::setThreadCount(const int threads)
+{
+    m_pool.setMaxThreadCount(std::clamp(threads, 1, MaxThreads) - 1);
+}
+
+void Writer::setSyncInterval(const int milliseconds)
+{
+    m_syncInterval.store(std::max(milliseconds, SyncNever), std::memory_order_relaxed);
+}
+
+void Writer::setRotation(const qint64 maxBytes, const qint64 maxAgeMs)
+{
+    m_rotateBytes.store(std::max<qint64>(maxBytes, 0), std::memory_order_relaxed);
+    m_rotateAgeMs.store(std::max<qint64>(maxAgeMs, 0), std::memory_order_relaxed);
 }
 
 void Writer::enqueue(const EventMessage &msg)
 {
-    QMutexLocker locker(&m_mutex);
-    m_queue.enqueue(msg);
-    m_wait.wakeOne();
+    m_queue->post(EventMessageBatch{msg});
+}
+
+void Writer::enqueue(const EventMessageBatch &batch)
+{
+    m_queue->post(batch);
+}
+
+std::shared_ptr<SinkQueue> Writer::sink() const
+{
+    return m_queue;
 }
 
 void Writer::run()
 {
+    if (!m_perModule)
+        m_routes.push_back(Route{std::make_unique<LogStream>(m_logFilePath, QString(), m_binaryFormat, m_compressor), {}});
+
     while (true)
     {
-        QMutexLocker locker(&m_mutex);
-        if (!m_running && m_queue.isEmpty()) break;
+        quint64 dropped {0};
+        // an open block waits at most BlockAgeMs for more messages
+        const QDeadlineTimer deadline = hasBufferedData()
+            ? QDeadlineTimer(BinaryLogWriter::BlockAgeMs) : QDeadlineTimer(QDeadlineTimer::Forever);
+        const EventMessageBatch batch = m_queue->waitAndTake(dropped, deadline);
+        if (batch.isEmpty() && m_queue->isClosed()) break;
+
+        const LogStream::Policy current = policy();
+        if (batch.isEmpty()) {
+            // idle, or woken by a sync()
+            flushRoutes(false);
+        } else if (m_perModule) {
+            for (const EventMessage &msg : batch)
+                route(msg.clientId).batch.append(msg);
+            writeRoutes(current);
+        } else {
+            m_routes.front().stream->write(batch, current);
+        }
 
-        if (m_queue.isEmpty())
-        {
-            m_wait.wait(&m_mutex);
+        QMutexLocker progressLocker(&m_progressMutex);
+        m_handled += static_cast<quint64>(batch.size()) + dropped;
+        const bool flushRequested = m_flushed < m_flushTarget;
+        progressLocker.unlock();
+        // without a sync() only blocks that are old enough, of modules that went
+        // quiet while others keep the queue busy
+        flushRoutes(!flushRequested);
+        progressLocker.relock();
+        if (flushRequested)
+            m_flushed = m_handled;
+        // rotated segments were fsynced when they were closed
+        m_activePaths.clear();
+        for (const Route &route : m_routes)
+            m_activePaths.append(route.stream->path());
+        m_progress.wakeAll();
+    }
+
+    // the closed segments go to the compressor, the next Writer starts new ones
+    const LogStream::Policy current = policy();
+    for (Route &route : m_routes)
+        route.stream->close(current);
+    m_routes.clear();
+
+    QMutexLocker progressLocker(&m_progressMutex);
+    m_flushed = m_handled;
+    m_progress.wakeAll();
+}
+
+LogStream::Policy Writer::policy() const
+{
+    return LogStream::Policy{m_syncInterval.load(std::memory_order_relaxed),
+                             m_rotateBytes.load(std::memory_order_relaxed),
+                             m_rotateAgeMs.load(std::memory_order_relaxed)};
+}
+
+// The stream of a module, created with its first message
+Writer::Route &Writer::route(const uint32_t clientId)
+{
+    const auto known = m_routeOfClient.constFind(clientId);
+    if (known != m_routeOfClient.cend())
+        return m_routes[*known];
+
+    const QString stream = streamName(clientId);
+    auto shared = m_routeOfStream.constFind(stream);
+    if (shared == m_routeOfStream.cend()) {
+        const QFileInfo first(m_logFilePath);
+        const QString path = LogStream::newSegmentPath(first.path(), stream, "." + first.suffix());
+        qDebug() << "Creating new log file:" << path;
+        m_routes.push_back(Route{std::make_unique<LogStream>(path, stream, m_binaryFormat, m_compressor), {}});
+        shared = m_routeOfStream.insert(stream, m_routes.size() - 1);
+    }
+    m_routeOfClient.insert(clientId, *shared);
+    return m_routes[*shared];
+}
+
+QString Writer::streamName(const uint32_t clientId) const
+{
+    const QString group = m_groups.value(clientId);
+    return group.isEmpty() ? QString("module%1").arg(clientId) : group;
+}
+
+// The first stream with messages is written on this thread, the others go to
+// the pool; returns when all are written
+void Writer::writeRoutes(const LogStream::Policy &policy)
+{
+    const bool parallel = m_pool.maxThreadCount() > 0;
+    Route *own {nullptr};
+    int started {0};
+    for (Route &route : m_routes) {
+        if (route.batch.isEmpty())
             continue;
+        if (!parallel) {
+            route.stream->write(route.batch, policy);
+        } else if (!own) {
+            own = &route;
+        } else {
+            Route *task = &route;
+            QSemaphore *done = &m_tasksDone;
+            m_pool.start([task, policy, done]() {
+                task->stream->write(task->batch, policy);
+                done->release();
+            });
+            ++started;
         }
+    }
+    if (own)
+        own->stream->write(own->batch, policy);
+    // not QThreadPool::waitForDone(), which also ends the idle pool threads
+    m_tasksDone.acquire(started);
+
+    for (Route &route : m_routes)
+        route.batch.clear();     // keeps the capacity
+}
+
+bool Writer::hasBufferedData() const
+{
+    return std::any_of(m_routes.cbegin(), m_routes.cend(),
+                       [](const Route &route) { return route.stream->hasBufferedData(); });
+}
+
+void Writer::flushRoutes(const bool expiredOnly)
+{
+    for (Route &route : m_routes)
+        route.stream->flush(expiredOnly);
+}
+
+bool Writer::sync(QDeadlineTimer deadline, quint64 &unwritten)
+{
+    const quint64 target = m_queue->postedCount();
+    QMutexLocker locker(&m_progressMutex);
+    // the open blocks are written after the batch that reaches the target
+    m_flushTarget = std::max(m_flushTarget, target);
+    locker.unlock();
+    m_queue->wakeConsumer();
+    locker.relock();
+    while (m_handled < target || m_flushed < target) {
+        if (!m_progress.wait(&m_progressMutex, deadline)) {
+            unwritten = target - std::min(m_handled, target);
+            return false;
+        }
+    }
+    const QStringList paths = m_activePaths;
+    locker.unlock();
 
-        EventMessage const msg = m_queue.dequeue();
-        QString const path = m_logFilePath;
-        locker.unlock();
-
-        QFile file(path);
-        if (file.open(QIODevice::Append | QIODevice::Text)) {
-            QTextStream out(&file);
-            out << msg.timestamp.toString("yyyy-MM-dd HH:mm:ss")
-                << " Module " << msg.clientId
-                << " [" << msg.type << "]: "
-                << msg.text << "\n";
+    unwritten = 0;
+    bool synced {true};
+    for (const QString &path : paths) {
+        if (!LogStream::syncFile(path)) {
+            qWarning() << "Cannot sync log file" << path;
+            synced = false;
         }
     }
+    return synced;
 }
 
 void Writer::finish()
 {
-    QMutexLocker locker(&m_mutex);
-    m_running = false;
-    m_wait.wakeAll();
+    m_queue->close();
 }
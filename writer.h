@@ -2,34 +2,112 @@
 #define WRITER_H
 
 #include <QObject>
-#include <QQueue>
+#include <QThread>
+#include <QThreadPool>
 #include <QMutex>
+#include <QSemaphore>
 #include <QWaitCondition>
-#include <QThread>
-#include <QFile>
-#include <QTextStream>
+#include <QDeadlineTimer>
+#include <QHash>
+#include <QStringList>
+#include <atomic>
+#include <memory>
+#include <vector>
 #include "eventmessage.h"
+#include "logcompressor.h"
+#include "logstream.h"
+#include "sinkqueue.h"
 
+// Persists the flushed messages on its own thread. The Logger posts to the
+// Writer's sink, a SinkQueue bounded in bytes, so the disk rate does not depend
+// on the other sinks and a stalled disk does not grow memory without limit;
+// what happens when it is full (block, drop by severity, spill) is the Logger's
+// choice of policy for the queue.
+// Each wake-up takes everything pending in one swap and hands it to the log
+// files: LogStreams that stay open for the session, write a whole batch at
+// once and rotate on their own. By default one stream takes all modules.
+// Routed per module, the batch is split by module (or by the group a module is
+// mapped to), keeping the order, and the streams with messages are written in
+// parallel: the Writer thread writes one, a pool of up to threadCount - 1
+// threads the others, and the next batch waits until all are done. A stream
+// thus never sees two batches at once and keeps its order, and the queue bound
+// still covers everything that is not written yet.
+// Binary streams keep the records of small batches in an open block; the
+// Writer writes it once no batch came for BinaryLogWriter::BlockAgeMs, once it
+// is that old even though other streams are busy, and when sync() asks.
 class Writer : public QThread {
     Q_OBJECT
 
 public:
+    static constexpr int SyncNever {-1};
+    static constexpr int SyncEveryBatch {0};
+    static constexpr int MaxThreads {8};
+
     explicit Writer(QObject *parent = nullptr);
     ~Writer();
 
+    // before start()
+    // The single log file; routed per module, the stream files go next to it in its format
     void setLogFilePath(const QString &path);
+    void setBinaryFormat(const bool binary);
+    void setCompressor(std::shared_ptr<LogCompressor> compressor);
+    // One file per module, modules mapped to the same group share one
+    void setRouting(const bool perModule, const QHash<uint32_t, QString> &groups = {});
+    // Threads writing the streams of a batch, the Writer thread included
+    void setThreadCount(const int threads);
+
+    // ms between fsyncs while writing, or SyncNever / SyncEveryBatch. Any thread.
+    void setSyncInterval(const int milliseconds);
+    // Segment size in bytes and age in ms, 0 = no limit. Any thread.
+    void setRotation(const qint64 maxBytes, const qint64 maxAgeMs);
     void enqueue(const EventMessage &msg);
+    void enqueue(const EventMessageBatch &batch);
+    std::shared_ptr<SinkQueue> sink() const;
     void finish();
 
+    // Waits until everything posted so far is written and fsyncs the active files.
+    // False if the deadline expired first, unwritten then receives what is still pending.
+    bool sync(QDeadlineTimer deadline, quint64 &unwritten);
+
 protected:
     void run() override;
 
+private:
+    struct Route {
+        std::unique_ptr<LogStream> stream;
+        EventMessageBatch batch;
+    };
+
+    LogStream::Policy policy() const;
+    Route &route(const uint32_t clientId);
+    void writeRoutes(const LogStream::Policy &policy);
+    bool hasBufferedData() const;
+    void flushRoutes(const bool expiredOnly);
+    QString streamName(const uint32_t clientId) const;
+
 private:
     QString m_logFilePath;
-    QQueue<EventMessage> m_queue;
-    QMutex m_mutex;
-    QWaitCondition m_wait;
-    bool m_running = true;
+    std::shared_ptr<SinkQueue> m_queue;
+    std::shared_ptr<LogCompressor> m_compressor;
+    bool m_binaryFormat {false};
+    bool m_perModule {false};
+    QHash<uint32_t, QString> m_groups;
+    std::atomic<int> m_syncInterval {SyncNever};
+    std::atomic<qint64> m_rotateBytes {0};
+    std::atomic<qint64> m_rotateAgeMs {0};
+    QMutex m_progressMutex;
+    QWaitCondition m_progress;
+    quint64 m_handled {0};      // written or dropped
+    quint64 m_flushTarget {0};  // a sync() waits for the open blocks up to this message
+    quint64 m_flushed {0};      // messages handled when the open blocks were last written
+    QStringList m_activePaths;  // segments a sync() covers, under m_progressMutex
+
+    // Writer thread only
+    QThreadPool m_pool;
+    QSemaphore m_tasksDone;     // released by every pool task of the batch
+    std::vector<Route> m_routes;
+    QHash<uint32_t, size_t> m_routeOfClient;
+    QHash<QString, size_t> m_routeOfStream;
 };
 
 #endif // WRITER_H